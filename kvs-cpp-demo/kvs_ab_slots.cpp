@@ -0,0 +1,215 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_ab_slots.cpp
+ * @brief Slot writes, commit record flips and recovery for AbSlotStore
+ */
+
+#include "kvs_ab_slots.hpp"
+#include "kvs_store_file.hpp"
+#include "internal/kvs_helper.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace kvs_demo {
+
+namespace {
+
+const char COMMIT_MAGIC[4] = {'K', 'V', 'S', 'C'};
+constexpr size_t COMMIT_RECORD_SIZE = 32;
+constexpr off_t COMMIT_RECORD_STRIDE = 512;
+
+void putBigEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+    }
+}
+
+uint64_t getBigEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+uint32_t adler32(const void* data, size_t size) {
+    return calculate_hash_adler32(std::string(static_cast<const char*>(data), size));
+}
+
+bool writeAll(int fd, const void* data, size_t size, off_t offset) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, bytes, size, offset);
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, size_t size, off_t offset) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t got = ::pread(fd, bytes, size, offset);
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        size -= static_cast<size_t>(got);
+        offset += got;
+    }
+    return true;
+}
+
+} // namespace
+
+AbSlotStore::AbSlotStore(const std::string& dir, InstanceId instance_id, size_t slot_capacity)
+    : slot_paths{storePath(dir, instance_id.id, "slot_a"), storePath(dir, instance_id.id, "slot_b")},
+      commit_path(storePath(dir, instance_id.id, "commit")),
+      slot_capacity{slot_capacity, slot_capacity} {}
+
+AbSlotStore::~AbSlotStore() {
+    for (int fd : slot_fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (commit_fd >= 0) {
+        ::close(commit_fd);
+    }
+}
+
+bool AbSlotStore::open() {
+    for (int slot = 0; slot < 2; ++slot) {
+        slot_fds[slot] = ::open(slot_paths[slot].c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (slot_fds[slot] < 0) {
+            return false;
+        }
+        off_t size = ::lseek(slot_fds[slot], 0, SEEK_END);
+        if (size > 0 && static_cast<size_t>(size) > slot_capacity[slot]) {
+            slot_capacity[slot] = static_cast<size_t>(size);
+        }
+        // Preallocate so that commits never have to extend the file
+        if (::posix_fallocate(slot_fds[slot], 0, static_cast<off_t>(slot_capacity[slot])) != 0) {
+            return false;
+        }
+    }
+
+    commit_fd = ::open(commit_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (commit_fd < 0) {
+        return false;
+    }
+
+    auto records = readCommitRecords();
+    if (!records.empty()) {
+        sequence_number = records.front().sequence;
+        active_slot = records.front().slot;
+    }
+    return true;
+}
+
+bool AbSlotStore::ensureCapacity(int slot, size_t size) {
+    if (size <= slot_capacity[slot]) {
+        return true;
+    }
+    size_t capacity = slot_capacity[slot];
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    if (::posix_fallocate(slot_fds[slot], 0, static_cast<off_t>(capacity)) != 0) {
+        return false;
+    }
+    slot_capacity[slot] = capacity;
+    return true;
+}
+
+bool AbSlotStore::commit(const std::string& payload) {
+    if (commit_fd < 0 || payload.size() > UINT32_MAX) {
+        return false;
+    }
+
+    int target = active_slot == 0 ? 1 : 0;
+    if (!ensureCapacity(target, payload.size()) ||
+        !writeAll(slot_fds[target], payload.data(), payload.size(), 0) ||
+        ::fdatasync(slot_fds[target]) != 0) {
+        return false;
+    }
+
+    uint64_t next_sequence = sequence_number + 1;
+    uint8_t record[COMMIT_RECORD_SIZE] = {};
+    std::memcpy(record, COMMIT_MAGIC, sizeof(COMMIT_MAGIC));
+    putBigEndian(record + 8, next_sequence, 8);
+    putBigEndian(record + 16, static_cast<uint32_t>(target), 4);
+    putBigEndian(record + 20, static_cast<uint32_t>(payload.size()), 4);
+    putBigEndian(record + 24, calculate_hash_adler32(payload), 4);
+    putBigEndian(record + 28, adler32(record, 28), 4);
+
+    off_t offset = static_cast<off_t>(next_sequence % 2) * COMMIT_RECORD_STRIDE;
+    if (!writeAll(commit_fd, record, sizeof(record), offset) || ::fdatasync(commit_fd) != 0) {
+        return false;
+    }
+
+    sequence_number = next_sequence;
+    active_slot = static_cast<uint32_t>(target);
+    return true;
+}
+
+std::vector<AbSlotStore::CommitRecord> AbSlotStore::readCommitRecords() {
+    std::vector<CommitRecord> records;
+    for (off_t copy = 0; copy < 2; ++copy) {
+        uint8_t record[COMMIT_RECORD_SIZE];
+        if (!readAll(commit_fd, record, sizeof(record), copy * COMMIT_RECORD_STRIDE)) {
+            continue;
+        }
+        if (std::memcmp(record, COMMIT_MAGIC, sizeof(COMMIT_MAGIC)) != 0 ||
+            getBigEndian(record + 28, 4) != adler32(record, 28)) {
+            continue;
+        }
+        CommitRecord candidate{getBigEndian(record + 8, 8),
+                               static_cast<uint32_t>(getBigEndian(record + 16, 4)),
+                               static_cast<uint32_t>(getBigEndian(record + 20, 4)),
+                               static_cast<uint32_t>(getBigEndian(record + 24, 4))};
+        if (candidate.slot > 1) {
+            continue;
+        }
+        records.push_back(candidate);
+    }
+    std::sort(records.begin(), records.end(),
+              [](const CommitRecord& a, const CommitRecord& b) { return a.sequence > b.sequence; });
+    return records;
+}
+
+std::optional<std::string> AbSlotStore::recover() {
+    if (commit_fd < 0) {
+        return std::nullopt;
+    }
+    // The older record names the slot that the newer commit did not touch,
+    // so it is still a valid fallback if the newer slot fails verification.
+    for (const auto& record : readCommitRecords()) {
+        std::string payload(record.length, '\0');
+        if (readAll(slot_fds[record.slot], payload.data(), payload.size(), 0) &&
+            calculate_hash_adler32(payload) == record.checksum) {
+            return payload;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace kvs_demo
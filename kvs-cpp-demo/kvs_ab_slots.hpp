@@ -0,0 +1,95 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_ab_slots.hpp
+ * @brief A/B double-buffered store files with a commit record
+ *
+ * Two preallocated slot files, kvs_<id>_slot_a and kvs_<id>_slot_b, hold the
+ * store payload. A small commit file, kvs_<id>_commit, names the valid slot:
+ *
+ *   offset  size  field
+ *   0       4     magic "KVSC"
+ *   4       4     reserved, zero
+ *   8       8     sequence number, big-endian
+ *   16      4     slot (0 = A, 1 = B), big-endian
+ *   20      4     payload length, big-endian
+ *   24      4     Adler-32 of the payload, big-endian
+ *   28      4     Adler-32 of bytes 0..27, big-endian
+ *
+ * The record is kept twice, at offsets 0 and 512, and written alternately by
+ * sequence parity so a torn record write still leaves the previous one
+ * intact. commit() writes the inactive slot, syncs it and only then writes
+ * the record; recover() reads the record with the highest valid sequence and
+ * the one slot it names, falling back to the older record if that slot does
+ * not verify.
+ */
+
+#ifndef KVS_DEMO_AB_SLOTS_HPP
+#define KVS_DEMO_AB_SLOTS_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+class AbSlotStore {
+public:
+    AbSlotStore(const std::string& dir, InstanceId instance_id, size_t slot_capacity = 64 * 1024);
+    ~AbSlotStore();
+
+    AbSlotStore(const AbSlotStore&) = delete;
+    AbSlotStore& operator=(const AbSlotStore&) = delete;
+
+    /// Open (and preallocate) the slot and commit files. Picks up the
+    /// current commit record if there is one.
+    bool open();
+
+    /// Write payload to the inactive slot and flip the commit record.
+    bool commit(const std::string& payload);
+
+    /// Return the payload named by the newest valid commit record.
+    std::optional<std::string> recover();
+
+    uint64_t sequence() const { return sequence_number; }
+    char activeSlot() const { return active_slot == 0 ? 'A' : 'B'; }
+
+private:
+    struct CommitRecord {
+        uint64_t sequence;
+        uint32_t slot;
+        uint32_t length;
+        uint32_t checksum;
+    };
+
+    std::vector<CommitRecord> readCommitRecords();
+    bool ensureCapacity(int slot, size_t size);
+
+    std::string slot_paths[2];
+    std::string commit_path;
+    size_t slot_capacity[2];
+    int slot_fds[2] = {-1, -1};
+    int commit_fd = -1;
+    uint64_t sequence_number = 0;
+    uint32_t active_slot = 1;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_AB_SLOTS_HPP
@@ -0,0 +1,344 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_blob_store.cpp
+ * @brief Blob file writing, mapping and garbage collection
+ */
+
+#include "kvs_blob_store.hpp"
+#include "kvs_store_file.hpp"
+#include "kvs_value_codec.hpp"
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kvs_demo {
+
+namespace {
+
+const char BLOB_NAME_KEY[] = "$blob";
+const char BLOB_SIZE_KEY[] = "$size";
+const char BLOB_TYPE_KEY[] = "$type";
+const char BLOB_SUFFIX[] = ".blob";
+
+// Names differing only in a -<n> suffix before giving up on a hash collision
+constexpr unsigned MAX_NAME_ATTEMPTS = 16;
+
+/// The FNV-1a hash a blob name starts with.
+std::optional<uint64_t> nameHash(const std::string& name) {
+    if (name.size() < 17 || name[16] != '-') {
+        return std::nullopt;
+    }
+    uint64_t hash = 0;
+    for (size_t i = 0; i < 16; ++i) {
+        char c = name[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) {
+            return std::nullopt;
+        }
+        hash = (hash << 4) | static_cast<uint64_t>(digit);
+    }
+    return hash;
+}
+
+} // namespace
+
+MappedBlob::~MappedBlob() {
+    if (address != nullptr) {
+        ::munmap(const_cast<void*>(address), length);
+    }
+}
+
+MappedBlob::MappedBlob(MappedBlob&& other) noexcept : address(other.address), length(other.length) {
+    other.address = nullptr;
+    other.length = 0;
+}
+
+MappedBlob& MappedBlob::operator=(MappedBlob&& other) noexcept {
+    if (this != &other) {
+        if (address != nullptr) {
+            ::munmap(const_cast<void*>(address), length);
+        }
+        address = other.address;
+        length = other.length;
+        other.address = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+std::optional<std::string_view> MappedBlob::stringView() const {
+    if (length < 5 || data()[0] != static_cast<uint8_t>(KvsValue::Type::String)) {
+        return std::nullopt;
+    }
+    uint32_t size = 0;
+    std::memcpy(&size, data() + 1, sizeof(size));
+    if (size != length - 5) {
+        return std::nullopt;
+    }
+    return std::string_view(reinterpret_cast<const char*>(data() + 5), size);
+}
+
+BlobStore::BlobStore(const std::string& dir, InstanceId instance_id, size_t inline_threshold)
+    : store_prefix(storePath(dir, instance_id.id, "")),
+      blob_dir(storePath(dir, instance_id.id, "blobs")),
+      inline_threshold(inline_threshold) {}
+
+bool BlobStore::open() {
+    return ::mkdir(blob_dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool BlobStore::isReference(const KvsValue& value) {
+    if (value.getType() != KvsValue::Type::Object) {
+        return false;
+    }
+    const auto& object = std::get<KvsValue::Object>(value.getValue());
+    auto name = object.find(BLOB_NAME_KEY);
+    return object.size() == 3 && name != object.end() && name->second &&
+           name->second->getType() == KvsValue::Type::String && object.count(BLOB_SIZE_KEY) == 1 &&
+           object.count(BLOB_TYPE_KEY) == 1;
+}
+
+std::optional<std::string> BlobStore::blobName(const KvsValue& reference) const {
+    if (!isReference(reference)) {
+        return std::nullopt;
+    }
+    const auto& object = std::get<KvsValue::Object>(reference.getValue());
+    const auto& name = std::get<std::string>(object.at(BLOB_NAME_KEY)->getValue());
+    // Names are generated by set_value(); refuse anything that could escape the directory
+    if (name.find('/') != std::string::npos || name.find("..") != std::string::npos) {
+        return std::nullopt;
+    }
+    return name;
+}
+
+bool BlobStore::isBytes(const KvsValue& value) {
+    if (!isReference(value)) {
+        return false;
+    }
+    const auto& type = std::get<KvsValue::Object>(value.getValue()).at(BLOB_TYPE_KEY);
+    return type && type->getType() == KvsValue::Type::i32 && std::get<int32_t>(type->getValue()) == BLOB_TYPE_BYTES;
+}
+
+std::optional<std::string> BlobStore::writeBlob(const void* data, size_t size) {
+    uint64_t hash = fnv1a64(data, size);
+    for (unsigned attempt = 0; attempt < MAX_NAME_ATTEMPTS; ++attempt) {
+        char name[80];
+        if (attempt == 0) {
+            std::snprintf(name, sizeof(name), "%016" PRIx64 "-%zu%s", hash, size, BLOB_SUFFIX);
+        } else {
+            std::snprintf(name, sizeof(name), "%016" PRIx64 "-%zu-%u%s", hash, size, attempt, BLOB_SUFFIX);
+        }
+        std::string path = blob_dir + "/" + name;
+
+        // Content-addressed: reuse an existing file only if it holds exactly these bytes
+        struct stat existing;
+        if (::stat(path.c_str(), &existing) == 0) {
+            auto blob = mapFile(path);
+            if (blob && blob->size() == size && (size == 0 || std::memcmp(blob->data(), data, size) == 0)) {
+                ++counters.blobs_reused;
+                return std::string(name);
+            }
+            // Same hash and size, different bytes: try the next name
+            continue;
+        }
+
+        SyscallCounter syscalls;
+        if (!writeFileAtomically(path, data, size, syscalls)) {
+            return std::nullopt;
+        }
+        ++counters.blobs_written;
+        counters.bytes_written += size;
+        return std::string(name);
+    }
+    return std::nullopt;
+}
+
+bool BlobStore::setReference(Kvs& kvs, const std::string& key, const std::string& name, size_t size, int32_t type) {
+    KvsValue::Object reference;
+    reference[BLOB_NAME_KEY] = std::make_shared<KvsValue>(KvsValue(name));
+    reference[BLOB_SIZE_KEY] = std::make_shared<KvsValue>(KvsValue(static_cast<uint64_t>(size)));
+    reference[BLOB_TYPE_KEY] = std::make_shared<KvsValue>(KvsValue(type));
+    return static_cast<bool>(kvs.set_value(key, KvsValue(reference)));
+}
+
+bool BlobStore::set_value(Kvs& kvs, const std::string& key, const KvsValue& value) {
+    if (encodedSize(value) <= inline_threshold) {
+        return static_cast<bool>(kvs.set_value(key, value));
+    }
+    return setOutOfLine(kvs, key, value);
+}
+
+bool BlobStore::spill(Kvs& kvs, const std::string& key, const KvsValue& value) {
+    return !isReference(value) && setOutOfLine(kvs, key, value);
+}
+
+bool BlobStore::setOutOfLine(Kvs& kvs, const std::string& key, const KvsValue& value) {
+    std::string encoded;
+    encoded.reserve(encodedSize(value));
+    if (!encodeValue(value, encoded)) {
+        return false;
+    }
+
+    auto name = writeBlob(encoded.data(), encoded.size());
+    return name && setReference(kvs, key, *name, encoded.size(), static_cast<int32_t>(value.getType()));
+}
+
+bool BlobStore::set_bytes(Kvs& kvs, const std::string& key, ByteSpan bytes) {
+    auto name = writeBlob(bytes.data, bytes.size);
+    return name && setReference(kvs, key, *name, bytes.size, BLOB_TYPE_BYTES);
+}
+
+std::optional<MappedBlob> BlobStore::get_bytes(Kvs& kvs, const std::string& key, BlobCheck check) const {
+    auto value_result = kvs.get_value(key);
+    if (!value_result || !isBytes(value_result.value())) {
+        return std::nullopt;
+    }
+    return map(value_result.value(), check);
+}
+
+std::optional<MappedBlob> BlobStore::map(const KvsValue& reference, BlobCheck check) const {
+    auto name = blobName(reference);
+    if (!name) {
+        return std::nullopt;
+    }
+    // blobName() accepted it, so it is an object with a $size member
+    const auto& size = std::get<KvsValue::Object>(reference.getValue()).at(BLOB_SIZE_KEY);
+    auto hash = nameHash(*name);
+    if (!hash || !size || size->getType() != KvsValue::Type::u64) {
+        return std::nullopt;
+    }
+    auto blob = mapFile(blob_dir + "/" + *name);
+    // A truncated or replaced file is refused rather than decoded; bit rot only by a Contents check
+    if (!blob || blob->size() != std::get<uint64_t>(size->getValue()) ||
+        (check == BlobCheck::Contents && fnv1a64(blob->data(), blob->size()) != *hash)) {
+        return std::nullopt;
+    }
+    return blob;
+}
+
+std::optional<MappedBlob> mapFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    if (info.st_size == 0) {
+        // mmap() rejects zero-length mappings; an empty blob is just an empty view
+        ::close(fd);
+        return MappedBlob();
+    }
+    void* address = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return std::nullopt;
+    }
+    return MappedBlob(address, static_cast<size_t>(info.st_size));
+}
+
+std::optional<KvsValue> BlobStore::get_value(Kvs& kvs, const std::string& key) {
+    auto value_result = kvs.get_value(key);
+    if (!value_result) {
+        return std::nullopt;
+    }
+    if (!isReference(value_result.value()) || isBytes(value_result.value())) {
+        return value_result.value();
+    }
+    auto blob = map(value_result.value(), BlobCheck::Contents);
+    if (!blob) {
+        return std::nullopt;
+    }
+    return decodeValue(blob->data(), blob->size());
+}
+
+bool BlobStore::markFileReferences(const std::string& path, std::unordered_set<std::string>& live) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        struct stat info;
+        return ::stat(path.c_str(), &info) != 0 && errno == ENOENT;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        return false;
+    }
+
+    // Conservative: every quoted "<...>.blob" string is kept, wherever it appears
+    const std::string suffix = std::string(BLOB_SUFFIX) + "\"";
+    for (size_t end = text.find(suffix); end != std::string::npos; end = text.find(suffix, end + 1)) {
+        size_t begin = text.rfind('"', end);
+        if (begin != std::string::npos) {
+            live.insert(text.substr(begin + 1, end + sizeof(BLOB_SUFFIX) - 1 - begin - 1));
+        }
+    }
+    return true;
+}
+
+size_t BlobStore::collectGarbage(Kvs& kvs) {
+    std::unordered_set<std::string> live;
+    auto keys_result = kvs.get_all_keys();
+    if (!keys_result) {
+        return 0;
+    }
+    for (const auto& key : keys_result.value()) {
+        auto value_result = kvs.get_value(key);
+        if (value_result) {
+            if (auto name = blobName(value_result.value())) {
+                live.insert(*name);
+            }
+        }
+    }
+
+    // Snapshots (and the defaults) may still refer to blobs the store has dropped
+    std::vector<std::string> store_files{store_prefix + "default.json"};
+    for (size_t id = 0; id <= kvs.snapshot_max_count(); ++id) {
+        store_files.push_back(store_prefix + std::to_string(id) + ".json");
+    }
+    for (const auto& path : store_files) {
+        if (!markFileReferences(path, live)) {
+            return 0;
+        }
+    }
+
+    DIR* dir = ::opendir(blob_dir.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+    size_t removed = 0;
+    while (struct dirent* entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() <= sizeof(BLOB_SUFFIX) - 1 ||
+            name.compare(name.size() - (sizeof(BLOB_SUFFIX) - 1), sizeof(BLOB_SUFFIX) - 1, BLOB_SUFFIX) != 0) {
+            continue;
+        }
+        if (live.count(name) == 0 && ::unlink((blob_dir + "/" + name).c_str()) == 0) {
+            ++removed;
+        }
+    }
+    ::closedir(dir);
+    return removed;
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,157 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_blob_store.hpp
+ * @brief Out-of-line, content-addressed storage for large values
+ *
+ * Values whose binary encoding (see kvs_value_codec.hpp) exceeds a threshold
+ * are written once to kvs_<id>_blobs/<fnv1a64>-<size>.blob and replaced in
+ * the store by a small reference object:
+ *
+ *   { "$blob": "<file name>", "$size": <encoded size>, "$type": <type ordinal> }
+ *
+ * Writing a value that is already present only compares it with the
+ * existing file, so a flush only rewrites the references. A name taken by
+ * different bytes of the same hash and size gets a -<n> suffix. Blobs are
+ * memory-mapped on read. map() checks the file size against the $size of
+ * the reference, which touches no page; BlobCheck::Contents also hashes
+ * the mapped bytes against the FNV-1a hash in the name, reading every
+ * page. get_value() asks for that, since decoding reads every byte anyway.
+ *
+ * collectGarbage() keeps every blob named in the in-memory store and in any
+ * of the instance's store files (current, snapshots and defaults), so
+ * snapshot_restore() never brings back a reference to a deleted blob.
+ *
+ * KvsValue has no byte-buffer type, so binary payloads are stored the same
+ * way: set_bytes() writes the raw bytes, unencoded, to a blob file and the
+ * reference carries $type BLOB_TYPE_BYTES. The Rust demo uses the identical
+ * layout, so byte values round-trip between both demos.
+ */
+
+#ifndef KVS_DEMO_BLOB_STORE_HPP
+#define KVS_DEMO_BLOB_STORE_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+/// $type of a reference to raw bytes; outside the KvsValue::Type ordinals.
+constexpr int32_t BLOB_TYPE_BYTES = 255;
+
+/// How much of a blob map() verifies before handing it out.
+enum class BlobCheck {
+    Size,       ///< File size against $size; the mapping stays untouched
+    Contents,   ///< Also the FNV-1a hash in the name, reading every page
+};
+
+/// Non-owning view of a byte buffer (std::span is C++20).
+struct ByteSpan {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/// Read-only memory mapping of one blob file.
+class MappedBlob {
+public:
+    MappedBlob() = default;
+    MappedBlob(const void* address, size_t length) : address(address), length(length) {}
+    ~MappedBlob();
+
+    MappedBlob(MappedBlob&& other) noexcept;
+    MappedBlob& operator=(MappedBlob&& other) noexcept;
+    MappedBlob(const MappedBlob&) = delete;
+    MappedBlob& operator=(const MappedBlob&) = delete;
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(address); }
+    size_t size() const { return length; }
+    ByteSpan bytes() const { return {data(), length}; }
+
+    /// View of an encoded String blob's characters, in place in the mapping.
+    std::optional<std::string_view> stringView() const;
+
+private:
+    const void* address = nullptr;
+    size_t length = 0;
+};
+
+/// Map a whole file read-only; an empty file gives an empty mapping.
+std::optional<MappedBlob> mapFile(const std::string& path);
+
+class BlobStore {
+public:
+    struct Stats {
+        size_t blobs_written = 0;
+        size_t blobs_reused = 0;
+        size_t bytes_written = 0;
+    };
+
+    BlobStore(const std::string& dir, InstanceId instance_id, size_t inline_threshold = 4096);
+
+    /// Create the blob directory if needed.
+    bool open();
+
+    /// Store value under key, out of line if it is larger than the threshold.
+    bool set_value(Kvs& kvs, const std::string& key, const KvsValue& value);
+
+    /// Store value under key out of line whatever its size, to take it out
+    /// of the Kvs's memory.
+    bool spill(Kvs& kvs, const std::string& key, const KvsValue& value);
+
+    /// Fetch key and resolve a blob reference into a decoded copy. Byte
+    /// references are returned as-is; use get_bytes() for those.
+    std::optional<KvsValue> get_value(Kvs& kvs, const std::string& key);
+
+    /// Store raw bytes under key; the bytes are written straight from the span.
+    bool set_bytes(Kvs& kvs, const std::string& key, ByteSpan bytes);
+
+    /// Map the bytes stored under key; bytes() views them without copying.
+    std::optional<MappedBlob> get_bytes(Kvs& kvs, const std::string& key, BlobCheck check = BlobCheck::Size) const;
+
+    /// Map the blob behind a reference without copying it; nothing if value
+    /// is not a reference, or the file is missing or fails check.
+    std::optional<MappedBlob> map(const KvsValue& reference, BlobCheck check = BlobCheck::Size) const;
+
+    /// Remove blob files that neither the store nor any snapshot or defaults
+    /// file refers to. Does nothing if one of those files cannot be read.
+    size_t collectGarbage(Kvs& kvs);
+
+    static bool isReference(const KvsValue& value);
+    static bool isBytes(const KvsValue& value);
+
+    const Stats& stats() const { return counters; }
+
+private:
+    std::optional<std::string> blobName(const KvsValue& reference) const;
+    std::optional<std::string> writeBlob(const void* data, size_t size);
+    bool setOutOfLine(Kvs& kvs, const std::string& key, const KvsValue& value);
+    bool setReference(Kvs& kvs, const std::string& key, const std::string& name, size_t size, int32_t type);
+    bool markFileReferences(const std::string& path, std::unordered_set<std::string>& live) const;
+
+    std::string store_prefix;
+    std::string blob_dir;
+    size_t inline_threshold;
+    Stats counters;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_BLOB_STORE_HPP
@@ -0,0 +1,85 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_build_stats.hpp
+ * @brief Timing and allocation counts of instance startup
+ *
+ * KvsBuilder::build() is a single library call with no hooks inside, so
+ * its open, read, checksum, JSON parse, defaults and map construction
+ * phases cannot be timed apart from the outside. Re-reading the files
+ * afterwards would only measure the page cache, not what build() spent.
+ * buildWithStats() therefore reports what can be measured honestly: the
+ * total time of build(), the size of the files it reads and the heap
+ * allocations it makes. With the USDT probes (kvs_probes.hpp) a tracer
+ * can attribute the build time to system calls from outside.
+ *
+ * Counting allocations needs a replacement of the global operator new that
+ * calls countAllocation(); a library cannot safely replace it for the whole
+ * program, so the program provides it in its main translation unit, as
+ * kvs_demo.cpp does. Without one, the counts stay 0.
+ */
+
+#ifndef KVS_DEMO_BUILD_STATS_HPP
+#define KVS_DEMO_BUILD_STATS_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+struct BuildStats {
+    std::chrono::microseconds build{0};     ///< KvsBuilder::build(), all phases together
+    size_t file_bytes = 0;                  ///< Store, .hash and (if required) defaults files
+    size_t allocations = 0;                 ///< During build()
+    size_t allocated_bytes = 0;
+    bool store_found = false;
+};
+
+/// Heap allocations made on the current thread while an instance is alive;
+/// scopes nest.
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+    size_t count() const { return allocations; }
+    size_t bytes() const { return allocated; }
+
+private:
+    friend void countAllocation(size_t size);
+
+    AllocationCounter* outer;
+    size_t allocations = 0;
+    size_t allocated = 0;
+};
+
+/// For the program's replacement of operator new: charge one allocation of
+/// size bytes to the counters active on this thread.
+void countAllocation(size_t size);
+
+/// Build the instance like KvsBuilder(instance_id).need_defaults_flag(...)
+/// .need_kvs_flag(...).dir(dir).build(), filling stats along the way.
+score::Result<Kvs> buildWithStats(InstanceId instance_id, const std::string& dir, bool need_defaults,
+                                  bool need_kvs, BuildStats& stats);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_BUILD_STATS_HPP
@@ -18,23 +18,95 @@
  * This program showcases the main capabilities of the persistency library:
  * - Creating and configuring KVS instances
  * - Working with different data types (integers, floats, booleans, strings, arrays, objects)
- * - Snapshot management and restoration
+ * - Snapshot management and restoration, with cached snapshot metadata
  * - Default values handling
  * - Persistence and file operations
  * - Thread-safe operations
+ * - Durability policies for flush (bench and crash-recovery modes)
+ * - Single-file store format with an embedded checksum
+ * - A/B double-buffered store slots for crash recovery
+ * - Out-of-line blob storage for large values
+ * - Raw byte values, shared with the Rust demo
+ * - Compressed time-series histories
+ * - Path-based partial updates of nested objects
+ * - Ordered key index with prefix and range scans
+ * - Secondary indexes on object fields
+ * - Predicate scans over a snapshot of the store
+ * - Expiring keys with per-key time-to-live
+ * - Change subscriptions delivered per commit
+ * - Per-instance memory budget with CLOCK eviction of values to disk
+ * - Prometheus metrics exported to a file and a Unix socket
+ * - Per-instance memory accounting by value type
+ * - Recording of operations and their replay (also --replay <file>)
+ * - Persistent objects and arrays with O(1) copies (bench mode)
+ * - Deduplication of repeated subtrees (bench mode)
+ * - Warm-start images for fast startup (bench mode)
+ * - Parallel startup of many instances (bench mode)
+ * - Directory manifest of instances and snapshots (bench mode)
+ * - Startup time and allocations of every instance (build-stats mode)
+ * - USDT tracepoints and their disabled overhead (bench mode)
+ * - Chrome trace-event export of operation spans (--trace)
  */
 
 #include "kvs/kvsbuilder.hpp"
 #include "internal/kvs_helper.hpp"
+#include "kvs_ab_slots.hpp"
+#include "kvs_blob_store.hpp"
+#include "kvs_build_stats.hpp"
+#include "kvs_durability.hpp"
+#include "kvs_field_index.hpp"
+#include "kvs_intern.hpp"
+#include "kvs_key_index.hpp"
+#include "kvs_manifest.hpp"
+#include "kvs_memory_stats.hpp"
+#include "kvs_metrics.hpp"
+#include "kvs_path.hpp"
+#include "kvs_persistent.hpp"
+#include "kvs_probes.hpp"
+#include "kvs_replay.hpp"
+#include "kvs_scan.hpp"
+#include "kvs_snapshot_info.hpp"
+#include "kvs_startup.hpp"
+#include "kvs_store_file.hpp"
+#include "kvs_subscribe.hpp"
+#include "kvs_timeseries.hpp"
+#include "kvs_trace.hpp"
+#include "kvs_tracked.hpp"
+#include "kvs_ttl.hpp"
+#include "kvs_value_cache.hpp"
+#include "kvs_value_codec.hpp"
+#include "kvs_warm_image.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <string>
 #include <memory>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <new>
+#include <thread>
+#include <unordered_set>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace score::mw::per::kvs;
+using kvs_demo::DurabilityPolicy;
+using kvs_demo::DurableFlusher;
+
+const DurabilityPolicy ALL_DURABILITY_POLICIES[] = {
+    DurabilityPolicy::Full,
+    DurabilityPolicy::DataOnly,
+    DurabilityPolicy::Deferred,
+    DurabilityPolicy::None,
+};
 
 // Color codes for better CLI output
 const std::string RESET = "\033[0m";
@@ -107,6 +179,13 @@ private:
                          << " elements]" << RESET << " (array)\n";
                 break;
             case KvsValue::Type::Object:
+                if (kvs_demo::BlobStore::isReference(value)) {
+                    const auto& size = std::get<KvsValue::Object>(value.getValue()).at("$size");
+                    bool is_bytes = kvs_demo::BlobStore::isBytes(value);
+                    std::cout << GREEN << (is_bytes ? "<" : "<blob of ") << std::get<uint64_t>(size->getValue())
+                             << " bytes>" << RESET << (is_bytes ? " (bytes)\n" : " (blob reference)\n");
+                    break;
+                }
                 std::cout << GREEN << "{object with " << std::get<KvsValue::Object>(value.getValue()).size()
                          << " properties}" << RESET << " (object)\n";
                 break;
@@ -230,6 +309,21 @@ public:
         kvs.set_value("device_config", KvsValue(device_config));
         printSuccess("Created object with device configuration");
 
+        printSubHeader("Updating a nested field by path");
+        kvs_demo::DirtyTracker dirty;
+        if (kvs_demo::set_path(kvs, "device_config/location", KvsValue(std::string("Room B")), &dirty)) {
+            auto location = kvs_demo::get_path(kvs, "device_config/location");
+            if (location) {
+                printKvsValue("device_config/location", location.value());
+            }
+            printSuccess("Only the path to 'location' was copied; the other fields are shared");
+        } else {
+            printError("Failed to update 'device_config/location'");
+        }
+        for (const char* path : {"device_config/location", "device_config/name"}) {
+            printInfo(std::string(path) + (dirty.isDirty(path) ? " is dirty" : " is clean"));
+        }
+
         printSubHeader("Reading complex data structures");
 
         auto keys_result = kvs.get_all_keys();
@@ -246,10 +340,11 @@ public:
         printSuccess("Complex data structures persisted");
     }
 
-    void demonstrateSnapshots() {
-        printHeader("Snapshot Management Demo");
+    void demonstrateBlobStorage() {
+        printHeader("Out-of-Line Blob Storage Demo");
 
-        auto builder_result = KvsBuilder(InstanceId(3))
+        InstanceId instance_id(7);
+        auto builder_result = KvsBuilder(instance_id)
             .need_defaults_flag(false)
             .need_kvs_flag(false)
             .dir(std::string(data_dir))
@@ -261,176 +356,298 @@ public:
         }
 
         Kvs kvs = std::move(builder_result.value());
+        kvs_demo::BlobStore blobs(data_dir, instance_id);
+        if (!blobs.open()) {
+            printError("Failed to create blob directory");
+            return;
+        }
 
-        printSubHeader("Setting up initial data");
-        kvs.set_value("version", KvsValue(static_cast<int32_t>(1)));
-        kvs.set_value("config", KvsValue(std::string("initial")));
-        kvs.flush();
-        printSuccess("Initial data created");
-
-        auto max_snapshots = kvs.snapshot_max_count();
-        printInfo("Maximum snapshots allowed: " + std::to_string(max_snapshots));
-
-        printSubHeader("Creating snapshots with data changes");
+        printSubHeader("Storing small and large values");
+        std::string firmware_notes(256 * 1024, '#');
+        blobs.set_value(kvs, "firmware_version", KvsValue(std::string("2.4.1")));
+        blobs.set_value(kvs, "firmware_notes", KvsValue(firmware_notes));
 
-        for (int i = 2; i <= 4; ++i) {
-            kvs.set_value("version", KvsValue(static_cast<int32_t>(i)));
-            kvs.set_value("config", KvsValue(std::string("config_v") + std::to_string(i)));
+        KvsValue::Array calibration;
+        for (int i = 0; i < 2048; ++i) {
+            calibration.push_back(std::make_shared<KvsValue>(KvsValue(0.001 * i)));
+        }
+        blobs.set_value(kvs, "calibration_table", KvsValue(calibration));
+        printSuccess("Stored 1 inline value and 2 blobs (" + std::to_string(blobs.stats().blobs_written) +
+                     " new, " + std::to_string(blobs.stats().bytes_written) + " bytes written)");
 
-            auto flush_result = kvs.flush();
-            if (flush_result) {
-                auto snapshot_count_result = kvs.snapshot_count();
-                auto count = snapshot_count_result ? snapshot_count_result.value() : 0;
-                printSuccess("Created snapshot " + std::to_string(i) + " (total: " +
-                           std::to_string(count) + ")");
+        auto keys_result = kvs.get_all_keys();
+        if (keys_result) {
+            for (const auto& key : keys_result.value()) {
+                auto value_result = kvs.get_value(key);
+                if (value_result) {
+                    printKvsValue(key, value_result.value());
+                }
             }
         }
 
-        printSubHeader("Current state before restoration");
-        auto current_version = kvs.get_value("version");
-        auto current_config = kvs.get_value("config");
-        if (current_version && current_config) {
-            printKvsValue("version", current_version.value());
-            printKvsValue("config", current_config.value());
+        printSubHeader("Re-storing an unchanged large value");
+        blobs.set_value(kvs, "firmware_notes", KvsValue(firmware_notes));
+        printSuccess("Blob reused, no blob bytes written (reused: " + std::to_string(blobs.stats().blobs_reused) + ")");
+
+        printSubHeader("Reading through a memory mapping");
+        auto reference = kvs.get_value("firmware_notes");
+        if (reference) {
+            auto blob = blobs.map(reference.value());
+            auto view = blob ? blob->stringView() : std::nullopt;
+            if (view) {
+                printSuccess("Mapped " + std::to_string(view->size()) + " characters without copying");
+            } else {
+                printError("Failed to map 'firmware_notes'");
+            }
+        }
+        auto table = blobs.get_value(kvs, "calibration_table");
+        if (table) {
+            printKvsValue("calibration_table", table.value());
         }
 
-        printSubHeader("Restoring from snapshot 1");
-        auto restore_result = kvs.snapshot_restore(SnapshotId(1));
-        if (restore_result) {
-            printSuccess("Successfully restored from snapshot 1");
+        kvs.flush();
+        printSuccess("Flushed; the store file only holds the references");
+
+        printSubHeader("Collecting unreferenced blobs");
+        blobs.set_value(kvs, "firmware_notes", KvsValue(std::string("See the release page")));
+        size_t removed = blobs.collectGarbage(kvs);
+        printSuccess("Removed " + std::to_string(removed) +
+                     " blobs; the old notes stay while the flushed store and its snapshots refer to them");
+        if (reference && !blobs.map(reference.value())) {
+            printError("A blob still referenced on disk was removed");
+        }
+    }
 
-            auto restored_version = kvs.get_value("version");
-            auto restored_config = kvs.get_value("config");
-            if (restored_version && restored_config) {
-                printKvsValue("version", restored_version.value());
-                printKvsValue("config", restored_config.value());
-            }
-        } else {
-            printError("Failed to restore from snapshot 1");
+    // Same deterministic pattern as calibration_pattern() in the Rust demo
+    static std::vector<uint8_t> makeCalibrationBlob(size_t size) {
+        std::vector<uint8_t> blob(size);
+        for (size_t i = 0; i < size; ++i) {
+            blob[i] = static_cast<uint8_t>((i * 31 + 7) & 0xff);
         }
+        return blob;
     }
 
-    void createDefaultsFile(InstanceId instance_id) {
-        std::string defaults_file_path = data_dir + "/kvs_" + std::to_string(instance_id.id) + "_default.json";
-        std::string defaults_hash_path = data_dir + "/kvs_" + std::to_string(instance_id.id) + "_default.hash";
+    void demonstrateBytes() {
+        printHeader("Raw Byte Values Demo");
 
-        // Create JSON in flat format (like C++ tests)
-        std::string defaults_content = R"({
-    "theme": {
-        "t": "str",
-        "v": "dark"
-    },
-    "language": {
-        "t": "str",
-        "v": "en"
-    },
-    "timeout": {
-        "t": "i32",
-        "v": 30
-    },
-    "auto_save": {
-        "t": "bool",
-        "v": true
-    },
-    "max_connections": {
-        "t": "i32",
-        "v": 100
-    }
-})";
+        InstanceId instance_id(8);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
 
-        // Create JSON file
-        std::ofstream defaults_file(defaults_file_path);
-        if (defaults_file.is_open()) {
-            defaults_file << defaults_content;
-            defaults_file.close();
-        } else {
-            printError("Failed to create defaults file: " + defaults_file_path);
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
             return;
         }
 
-        // Create hash file using persistency's Adler-32 implementation
-        uint32_t defaults_hash = calculate_hash_adler32(defaults_content);
-        std::array<uint8_t, 4> hash_bytes = get_hash_bytes_adler32(defaults_hash);
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::BlobStore blobs(data_dir, instance_id);
+        if (!blobs.open()) {
+            printError("Failed to create blob directory");
+            return;
+        }
 
-        std::ofstream defaults_hash_file(defaults_hash_path, std::ios::binary);
-        if (defaults_hash_file.is_open()) {
-            defaults_hash_file.write(reinterpret_cast<const char*>(hash_bytes.data()), 4);
-            defaults_hash_file.close();
+        printSubHeader("Storing a binary calibration blob");
+        std::vector<uint8_t> calibration = makeCalibrationBlob(1500);
+        if (blobs.set_bytes(kvs, "cpp_calibration", {calibration.data(), calibration.size()})) {
+            printSuccess("Stored " + std::to_string(calibration.size()) + " raw bytes (no base64, no array of integers)");
         } else {
-            printError("Failed to create defaults hash file: " + defaults_hash_path);
+            printError("Failed to store 'cpp_calibration'");
         }
-    }
 
-    void demonstrateDefaults() {
-        printHeader("Default Values Demo");
+        printSubHeader("Reading byte values through a mapping");
+        const std::pair<const char*, size_t> expected[] = {{"cpp_calibration", 1500}, {"rust_calibration", 1700}};
+        for (const auto& [key, size] : expected) {
+            auto blob = blobs.get_bytes(kvs, key);
+            if (!blob) {
+                printInfo(std::string("Key '") + key + "' not present (run the other demo on the same directory)");
+                continue;
+            }
+            kvs_demo::ByteSpan bytes = blob->bytes();
+            std::vector<uint8_t> reference = makeCalibrationBlob(size);
+            if (bytes.size == reference.size() && std::equal(reference.begin(), reference.end(), bytes.data)) {
+                printSuccess(std::string("Verified '") + key + "' (" + std::to_string(bytes.size) + " bytes, zero-copy)");
+            } else {
+                printError(std::string("Content mismatch for '") + key + "'");
+            }
+        }
 
-        InstanceId instance_id(5);
+        auto value_result = kvs.get_value("cpp_calibration");
+        if (value_result) {
+            printKvsValue("cpp_calibration", value_result.value());
+        }
 
-        printSubHeader("Creating defaults file manually (as required by persistency)");
-        createDefaultsFile(instance_id);
-        printSuccess("Defaults file created manually");
+        kvs.flush();
+        printSuccess("Byte references persisted");
+    }
 
-        printSubHeader("Creating KVS with required defaults");
+    void demonstrateTimeSeries() {
+        printHeader("Time-Series Values Demo");
+
+        InstanceId instance_id(9);
         auto builder_result = KvsBuilder(instance_id)
-            .need_defaults_flag(true)   // Require defaults file
+            .need_defaults_flag(false)
             .need_kvs_flag(false)
             .dir(std::string(data_dir))
             .build();
 
         if (!builder_result) {
-            printError("Failed to create KVS instance with defaults - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
             return;
         }
 
         Kvs kvs = std::move(builder_result.value());
-        printSuccess("KVS instance created with defaults");
+        kvs_demo::BlobStore blobs(data_dir, instance_id);
+        if (!blobs.open()) {
+            printError("Failed to create blob directory");
+            return;
+        }
 
-        printSubHeader("Reading default values");
+        printSubHeader("Recording a rolling sensor history");
+        const size_t capacity = 4096;
+        const int sample_count = 5000;
+        kvs_demo::TimeSeries history(capacity);
+        KvsValue::Array boxed_readings;
+        int64_t timestamp = 1735689600000;  // 2025-01-01, in milliseconds
+        double temperature = 23.5;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < sample_count; ++i) {
+            timestamp += 1000 + (i % 3);
+            temperature = std::round((temperature + ((i * 7) % 11 - 5) / 100.0) * 10) / 10;
+            history.append(timestamp, temperature);
+        }
+        auto append_time = std::chrono::steady_clock::now() - start;
 
-        std::vector<std::string> default_keys = {"theme", "language", "timeout", "auto_save", "max_connections"};
-        for (const auto& key : default_keys) {
-            auto default_result = kvs.get_default_value(key);
-            if (default_result) {
-                std::cout << "  Default ";
-                printKvsValue(key, default_result.value());
-            }
+        for (const auto& sample : history.samples().value_or(std::vector<kvs_demo::TimeSeries::Sample>{})) {
+            boxed_readings.push_back(std::make_shared<KvsValue>(KvsValue(sample.value)));
+        }
+        printSuccess("Appended " + std::to_string(sample_count) + " samples in " +
+                     std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(append_time).count()) +
+                     " us, keeping " + std::to_string(history.size()) + " (capacity " + std::to_string(capacity) + ")");
+
+        std::string encoded = history.serialize();
+        std::cout << "  Compressed timestamps + values: " << GREEN << encoded.size() << " bytes" << RESET
+                  << " (" << std::fixed << std::setprecision(2)
+                  << static_cast<double>(encoded.size()) / static_cast<double>(history.size()) << " bytes/sample)\n";
+        std::cout << "  Boxed f64 array, values only:   " << YELLOW << kvs_demo::encodedSize(KvsValue(boxed_readings))
+                  << " bytes" << RESET << " in binary, more as JSON\n";
+
+        printSubHeader("Persisting and decoding the history");
+        if (!blobs.set_bytes(kvs, "sensor_history", {reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size()})) {
+            printError("Failed to store 'sensor_history'");
+            return;
         }
+        kvs.flush();
 
-        printSubHeader("Overriding some defaults");
-        kvs.set_value("theme", KvsValue(std::string("light")));
-        kvs.set_value("timeout", KvsValue(static_cast<int32_t>(60)));
-        printSuccess("Overrode 'theme' and 'timeout' values");
+        auto blob = blobs.get_bytes(kvs, "sensor_history");
+        auto restored = blob ? kvs_demo::TimeSeries::deserialize(blob->data(), blob->size()) : std::nullopt;
+        if (!restored) {
+            printError("Failed to decode 'sensor_history'");
+            return;
+        }
+        auto samples = restored->samples();
+        if (samples && samples->size() == history.size() && !samples->empty()) {
+            printSuccess("Decoded " + std::to_string(samples->size()) + " samples in bulk");
+            std::cout << "  Latest sample: t=" << samples->back().timestamp << " value=" << std::fixed
+                      << std::setprecision(1) << samples->back().value << "\n";
+        } else {
+            printError("Decoded history does not match");
+        }
+    }
 
-        printSubHeader("Current values (mix of defaults and overrides)");
-        for (const auto& key : default_keys) {
-            auto value_result = kvs.get_value(key);
-            if (value_result) {
-                auto is_default = !kvs.key_exists(key).value_or(false);
-                std::cout << "  " << (is_default ? "(default) " : "(custom)  ");
-                printKvsValue(key, value_result.value());
+    void demonstrateKeyIndex() {
+        printHeader("Ordered Key Index Demo");
+
+        InstanceId instance_id(11);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        kvs_demo::OrderedKeyIndex index;
+        tracked.add_listener(index);
+
+        printSubHeader("Writing hierarchical keys");
+        const char* rooms[] = {"room_a", "room_b", "room_c", "room_d"};
+        const char* metrics[] = {"temperature", "humidity", "co2"};
+        for (int room = 0; room < 4; ++room) {
+            for (int metric = 0; metric < 3; ++metric) {
+                for (int i = 0; i < 250; ++i) {
+                    std::string key = std::string("sensor/") + rooms[room] + "/" + metrics[metric] + "_" + std::to_string(i);
+                    tracked.set_value(key, KvsValue(20.0 + room + 0.1 * i));
+                }
+            }
+        }
+        tracked.remove_key("sensor/room_a/co2_0");
+        printSuccess("Indexed " + std::to_string(index.size()) + " keys");
+
+        printSubHeader("Prefix scan: sensor/room_a/temperature_1");
+        size_t shown = 0;
+        size_t matches = 0;
+        for (const auto& key : index.scan_prefix("sensor/room_a/temperature_1")) {
+            if (shown++ < 3) {
+                std::cout << "  " << CYAN << key << RESET << "\n";
+            }
+            ++matches;
+        }
+        printInfo("... " + std::to_string(matches) + " keys in sorted order");
+
+        printSubHeader("Range scan: [sensor/room_b/, sensor/room_d/)");
+        auto range = index.scan_range("sensor/room_b/", "sensor/room_d/");
+        printInfo(std::to_string(std::distance(range.begin(), range.end())) + " keys in rooms b and c");
+
+        printSubHeader("Index vs filtering get_all_keys()");
+        const int rounds = 100;
+        auto start = std::chrono::steady_clock::now();
+        size_t filtered = 0;
+        for (int round = 0; round < rounds; ++round) {
+            auto keys_result = tracked.get_all_keys();
+            if (keys_result) {
+                for (const auto& key : keys_result.value()) {
+                    filtered += key.rfind("sensor/room_a/", 0) == 0 ? 1 : 0;
+                }
             }
         }
+        auto filter_time = std::chrono::steady_clock::now() - start;
 
-        printSubHeader("Resetting a key to default");
-        auto reset_result = kvs.reset_key("theme");
-        if (reset_result) {
-            printSuccess("Reset 'theme' to default value");
-            auto value_result = kvs.get_value("theme");
-            if (value_result) {
-                std::cout << "  ";
-                printKvsValue("theme", value_result.value());
+        start = std::chrono::steady_clock::now();
+        size_t scanned = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& key : index.scan_prefix("sensor/room_a/")) {
+                scanned += key.empty() ? 0 : 1;
             }
         }
+        auto scan_time = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  get_all_keys() + filter: " << YELLOW << std::fixed << std::setprecision(1)
+                  << std::chrono::duration<double, std::micro>(filter_time).count() / rounds << " us" << RESET << "\n";
+        std::cout << "  scan_prefix():           " << GREEN << std::fixed << std::setprecision(1)
+                  << std::chrono::duration<double, std::micro>(scan_time).count() / rounds << " us" << RESET << "\n";
+        if (filtered == scanned) {
+            printSuccess("Both found " + std::to_string(scanned / rounds) + " keys under sensor/room_a/");
+        } else {
+            printError("Index and full scan disagree");
+        }
 
-        kvs.flush();
-        printSuccess("Configuration saved with defaults");
+        tracked.flush();
     }
 
-    void demonstrateReset() {
-        printHeader("Reset Operations Demo");
-
+    void demonstrateSecondaryIndexes() {
+        printHeader("Secondary Indexes Demo");
 
-        auto builder_result = KvsBuilder(InstanceId(6))
+        InstanceId instance_id(12);
+        auto builder_result = KvsBuilder(instance_id)
             .need_defaults_flag(false)
             .need_kvs_flag(false)
             .dir(std::string(data_dir))
@@ -442,80 +659,1947 @@ public:
         }
 
         Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        const char* locations[] = {"Room A", "Room B", "Hall", "Lab"};
+        const size_t device_count = 2000;
+        for (size_t i = 0; i < device_count; ++i) {
+            KvsValue::Object config;
+            config["enabled"] = std::make_shared<KvsValue>(KvsValue(i % 3 != 0));
+            config["location"] = std::make_shared<KvsValue>(KvsValue(std::string(locations[i % 4])));
+            config["max_temp"] = std::make_shared<KvsValue>(KvsValue(75.5));
+            tracked.set_value("device_" + std::to_string(i), KvsValue(config));
+        }
 
-        printSubHeader("Adding test data");
-        kvs.set_value("test1", KvsValue(std::string("value1")));
-        kvs.set_value("test2", KvsValue(static_cast<int32_t>(42)));
-        kvs.set_value("test3", KvsValue(true));
-
-        auto initial_count = kvs.get_all_keys().value_or(std::vector<std::string>{}).size();
-        printSuccess("Added " + std::to_string(initial_count) + " test entries");
-
-        printSubHeader("Performing complete reset");
-        auto reset_result = kvs.reset();
-        if (reset_result) {
-            auto final_count = kvs.get_all_keys().value_or(std::vector<std::string>{}).size();
-            printSuccess("Reset complete - " + std::to_string(final_count) + " entries remaining");
-
-            if (final_count == 0) {
-                printSuccess("KVS is now empty");
+        printSubHeader("Declaring indexes on existing data");
+        kvs_demo::FieldIndex by_location("location");
+        kvs_demo::FieldIndex by_enabled("enabled");
+        tracked.add_listener(by_location);
+        tracked.add_listener(by_enabled);
+        printSuccess("Indexed 'location' and 'enabled' for " + std::to_string(by_location.size()) + " devices");
+
+        printSubHeader("Querying");
+        KvsValue room_a(std::string("Room A"));
+        auto in_room_a = by_location.query(room_a);
+        printInfo(std::to_string(in_room_a.size()) + " devices in Room A, " +
+                  std::to_string(by_enabled.query(KvsValue(true)).size()) + " enabled");
+
+        printSubHeader("Incremental maintenance");
+        KvsValue::Object moved;
+        moved["enabled"] = std::make_shared<KvsValue>(KvsValue(true));
+        moved["location"] = std::make_shared<KvsValue>(KvsValue(std::string("Room A")));
+        tracked.set_value("device_1", KvsValue(moved));
+        tracked.remove_key("device_0");
+        printInfo("Moved device_1 to Room A and removed device_0: " +
+                  std::to_string(by_location.query(room_a).size()) + " devices in Room A");
+
+        printSubHeader("Index vs fetching every value");
+        auto start = std::chrono::steady_clock::now();
+        size_t scanned = 0;
+        auto keys_result = tracked.get_all_keys();
+        if (keys_result) {
+            for (const auto& key : keys_result.value()) {
+                auto value_result = tracked.get_value(key);
+                if (value_result) {
+                    const KvsValue* location = kvs_demo::findPath(value_result.value(), {"location"}, 0);
+                    scanned += location && kvs_demo::valuesEqual(*location, room_a) ? 1 : 0;
+                }
             }
-        } else {
-            printError("Reset failed");
         }
-    }
+        auto scan_time = std::chrono::steady_clock::now() - start;
 
-    void run() {
-        std::cout << BOLD << GREEN << "\n🚀 KVS C++ Library Demonstration Program" << RESET << "\n";
-        std::cout << BLUE << "Data directory: " << data_dir << RESET << "\n\n";
+        start = std::chrono::steady_clock::now();
+        size_t queried = by_location.query(room_a).size();
+        auto query_time = std::chrono::steady_clock::now() - start;
 
-        printInfo("Press Enter to continue between demonstrations...");
+        std::cout << "  full scan: " << YELLOW << std::chrono::duration_cast<std::chrono::microseconds>(scan_time).count()
+                  << " us" << RESET << ", query(): " << GREEN
+                  << std::chrono::duration_cast<std::chrono::microseconds>(query_time).count() << " us" << RESET << "\n";
+        if (scanned == queried) {
+            printSuccess("Both found " + std::to_string(queried) + " devices in Room A");
+        } else {
+            printError("Index and full scan disagree");
+        }
 
-        demonstrateBasicOperations();
-        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
-        std::cin.get();
+        tracked.flush();
+    }
 
-        demonstrateArraysAndObjects();
-        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
-        std::cin.get();
+    void demonstratePredicateScan() {
+        printHeader("Predicate Scan Demo");
 
-        demonstrateSnapshots();
-        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
-        std::cin.get();
+        InstanceId instance_id(14);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
 
-        demonstrateDefaults();
-        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
-        std::cin.get();
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
 
-        demonstrateReset();
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        kvs_demo::ScanView view;
+        tracked.add_listener(view);
+
+        printSubHeader("Writing mixed readings");
+        const int reading_count = 3000;
+        for (int i = 0; i < reading_count; ++i) {
+            std::string key = "reading_" + std::to_string(i);
+            if (i % 10 == 0) {
+                tracked.set_value(key, KvsValue(std::string("sensor offline")));
+            } else if (i % 10 == 1) {
+                tracked.set_value(key, KvsValue(static_cast<int32_t>(i % 50)));
+            } else {
+                tracked.set_value(key, KvsValue(15.0 + (i * 37 % 200) / 10.0));
+            }
+        }
+        printSuccess("Wrote " + std::to_string(reading_count) + " readings");
+
+        using kvs_demo::greaterThan;
+        using kvs_demo::hasType;
+        auto hot = hasType(KvsValue::Type::f64) && greaterThan(30.0);
+
+        printSubHeader("scan(type == f64 && value > 30)");
+        auto start = std::chrono::steady_clock::now();
+        auto matches = view.scan(hot);
+        auto scan_time = std::chrono::steady_clock::now() - start;
+        for (size_t i = 0; i < matches.size() && i < 3; ++i) {
+            printKvsValue(matches[i].first, matches[i].second);
+        }
+        printInfo("... " + std::to_string(matches.size()) + " matches, " + std::to_string(matches.size()) + " values copied");
 
-        printHeader("Demonstration Complete");
-        printSuccess("All KVS features have been demonstrated!");
-        printInfo("Check the files in '" + data_dir + "' to see the persisted data");
+        printSubHeader("Same filter through get_all_keys() and get_value()");
+        start = std::chrono::steady_clock::now();
+        size_t copied = 0;
+        size_t client_matches = 0;
+        auto keys_result = tracked.get_all_keys();
+        if (keys_result) {
+            for (const auto& key : keys_result.value()) {
+                auto value_result = tracked.get_value(key);
+                if (value_result) {
+                    ++copied;
+                    client_matches += hot(value_result.value()) ? 1 : 0;
+                }
+            }
+        }
+        auto client_time = std::chrono::steady_clock::now() - start;
+        printInfo(std::to_string(client_matches) + " matches, " + std::to_string(copied) + " values copied");
+
+        std::cout << "  scan():            " << GREEN << std::chrono::duration_cast<std::chrono::microseconds>(scan_time).count()
+                  << " us" << RESET << "\n";
+        std::cout << "  client-side check: " << YELLOW << std::chrono::duration_cast<std::chrono::microseconds>(client_time).count()
+                  << " us" << RESET << "\n";
+        if (client_matches == matches.size()) {
+            printSuccess("Both filters agree");
+        } else {
+            printError("scan() and the client-side filter disagree");
+        }
 
-        std::cout << BOLD << GREEN << "\n✨ Thank you for exploring the KVS C++ library!" << RESET << "\n\n";
+        tracked.flush();
     }
-};
 
-int main(int argc, char* argv[]) {
-    std::string data_dir = "./kvs_demo_data";
+    void demonstrateExpiringKeys() {
+        printHeader("Expiring Keys Demo");
 
-    if (argc > 1) {
-        data_dir = argv[1];
-    }
+        InstanceId instance_id(15);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        kvs_demo::ExpiringKvs expiring(tracked, data_dir, instance_id);
+        if (!expiring.load()) {
+            printError("Ignoring a corrupted TTL file");
+        }
+
+        printSubHeader("Setting values with a time-to-live");
+        using std::chrono::milliseconds;
+        expiring.set_value("status", KvsValue(std::string("online")), milliseconds(100));
+        expiring.set_value("session_token", KvsValue(std::string("a1b2c3d4")), milliseconds(300));
+        tracked.set_value("device_name", KvsValue(std::string("gateway-7")));
+        printSuccess("'status' expires in 100 ms, 'session_token' in 300 ms, 'device_name' never");
+
+        std::this_thread::sleep_for(milliseconds(150));
+        printSubHeader("After 150 ms");
+        for (const char* key : {"status", "session_token", "device_name"}) {
+            auto value = expiring.get_value(key);
+            auto ttl = expiring.ttl(key);
+            if (value) {
+                printKvsValue(key, *value);
+                if (ttl) {
+                    printInfo(std::string("  '") + key + "' has " + std::to_string(ttl->count()) + " ms left");
+                }
+            } else {
+                printInfo(std::string("'") + key + "' has expired (removed on read)");
+            }
+        }
+
+        printSubHeader("Flushing after the token's deadline");
+        std::this_thread::sleep_for(milliseconds(200));
+        if (expiring.flush()) {
+            auto exists = kvs.key_exists("session_token");
+            bool persisted = exists && exists.value();
+            printSuccess(std::string("Flushed; 'session_token' ") + (persisted ? "was persisted" : "was expired first and not persisted"));
+        } else {
+            printError("Flush failed");
+        }
+
+        printSubHeader("Timer wheel cost");
+        kvs_demo::TimerWheel wheel;
+        const int timer_count = 100000;
+        auto start = kvs_demo::TimerWheel::Clock::now();
+        for (int i = 0; i < timer_count; ++i) {
+            wheel.schedule("token_" + std::to_string(i), start + milliseconds(1 + i * 37 % 3600000));
+        }
+        for (int i = 0; i < timer_count; i += 2) {
+            wheel.cancel("token_" + std::to_string(i));
+        }
+        auto elapsed = kvs_demo::TimerWheel::Clock::now() - start;
+        std::cout << "  " << timer_count << " schedules + " << timer_count / 2 << " cancels: " << GREEN << std::fixed
+                  << std::setprecision(0) << std::chrono::duration<double, std::nano>(elapsed).count() / (timer_count * 1.5)
+                  << " ns" << RESET << " per operation, independent of the number of timers\n";
+    }
+
+    void demonstrateSubscriptions() {
+        printHeader("Change Subscriptions Demo");
+
+        InstanceId instance_id(16);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+
+        // Callbacks run on the dispatcher thread; collect their output here.
+        // Declared before the hub, so the dispatcher is stopped before they go.
+        std::mutex output_mutex;
+        std::vector<std::string> output;
+        auto report = [&output_mutex, &output](const std::string& name) {
+            return [&output_mutex, &output, name](const std::vector<kvs_demo::Change>& changes) {
+                std::string line = name + " got " + std::to_string(changes.size()) + " change(s):";
+                for (const auto& change : changes) {
+                    line += " " + (change.kind == kvs_demo::Change::Kind::Remove ? "-" + change.key : change.key);
+                }
+                std::lock_guard<std::mutex> lock(output_mutex);
+                output.push_back(line);
+            };
+        };
+        kvs_demo::SubscriptionHub hub;
+        // Only changes from here on; the keys of earlier runs are not news
+        tracked.add_listener(hub, false);
+        hub.subscribe("config/log_level", report("log_level watcher"));
+        hub.subscribe("sensor/room_a/*", report("room_a watcher"));
+        printSuccess("Subscribed to 'config/log_level' and 'sensor/room_a/*'");
+
+        printSubHeader("Writing without flushing");
+        tracked.set_value("config/log_level", KvsValue(std::string("info")));
+        tracked.set_value("config/log_level", KvsValue(std::string("debug")));
+        for (int i = 0; i < 3; ++i) {
+            tracked.set_value("sensor/room_a/temp_" + std::to_string(i), KvsValue(21.0 + i));
+            tracked.set_value("sensor/room_b/temp_" + std::to_string(i), KvsValue(19.0 + i));
+        }
+        tracked.remove_key("sensor/room_a/temp_2");
+        hub.wait_delivered(std::chrono::milliseconds(100));
+        size_t early = 0;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            early = output.size();
+        }
+        printInfo("Nothing is delivered before the commit: " + std::to_string(early) + " notifications");
+
+        printSubHeader("Flushing delivers one coalesced batch per subscriber");
+        tracked.flush();
+        if (!hub.wait_delivered(std::chrono::milliseconds(1000))) {
+            printError("Notifications were not delivered in time");
+            return;
+        }
+        std::lock_guard<std::mutex> lock(output_mutex);
+        for (const auto& line : output) {
+            std::cout << "  " << CYAN << line << RESET << "\n";
+        }
+        printSuccess("Writers only pushed onto a lock-free queue; delivery ran on the dispatcher thread");
+    }
+
+    void demonstrateMemoryBudget() {
+        printHeader("Memory Budget Demo");
+
+        InstanceId instance_id(17);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::BlobStore blobs(data_dir, instance_id);
+        if (!blobs.open()) {
+            printError("Failed to create blob directory");
+            return;
+        }
+
+        const size_t budget = 512 * 1024;
+        kvs_demo::ResidentValueCache cache(kvs, blobs, budget);
+        if (!cache.load()) {
+            printError("Values from earlier runs do not fit the budget");
+        }
+
+        printSubHeader("Storing 32 map tiles of 64 KiB and 64 route notes of 2 KiB under a 512 KiB budget");
+        const int tile_count = 32;
+        for (int i = 0; i < tile_count; ++i) {
+            std::string tile(64 * 1024, static_cast<char>('A' + i % 26));
+            tile.replace(0, 8, "tile_" + std::to_string(100 + i));
+            cache.set_value("map_tile_" + std::to_string(i), KvsValue(tile));
+        }
+        // Small enough to be stored inline, but charged and spilled all the same
+        const int note_count = 64;
+        for (int i = 0; i < note_count; ++i) {
+            cache.set_value("route_note_" + std::to_string(i), KvsValue("note_" + std::string(2 * 1024, 'n')));
+        }
+        kvs.flush();
+        const auto& stats = cache.stats();
+        printSuccess(std::to_string(cache.residentCount()) + " values resident, " +
+                     std::to_string(cache.residentBytes() / 1024) + " KiB of " + std::to_string(budget / 1024) +
+                     " KiB; " + std::to_string(stats.evictions) + " evicted to their blob files");
+
+        printSubHeader("Reading: 4 hot tiles often, the other tiles and notes now and then");
+        size_t verified = 0;
+        size_t reads = 0;
+        for (int round = 0; round < 200; ++round) {
+            std::string key;
+            if (round % 5 != 4) {
+                key = "map_tile_" + std::to_string(round % 4);
+            } else if (round % 10 == 4) {
+                key = "map_tile_" + std::to_string((round * 7) % tile_count);
+            } else {
+                key = "route_note_" + std::to_string((round * 3) % note_count);
+            }
+            auto value = cache.get_value(key);
+            ++reads;
+            if (value && value->getType() == KvsValue::Type::String &&
+                std::get<std::string>(value->getValue()).compare(0, 5, key[0] == 'm' ? "tile_" : "note_") == 0) {
+                ++verified;
+            }
+        }
+        std::cout << "  hits: " << GREEN << stats.hits << RESET << ", faults from disk: " << YELLOW << stats.misses
+                  << RESET << ", evictions: " << stats.evictions << " (" << stats.spills << " spills)\n";
+        std::cout << "  resident: " << cache.residentBytes() / 1024 << " KiB (budget " << budget / 1024 << " KiB)\n";
+        if (verified == reads && cache.residentBytes() <= budget) {
+            printSuccess("All " + std::to_string(reads) + " reads returned the right value within the budget");
+        } else {
+            printError("Some reads failed or the budget was exceeded");
+        }
+    }
+
+    /// Read everything a local metrics socket answers, as a scraper would.
+    static std::optional<std::string> scrapeUnixSocket(const std::string& path) {
+        struct sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            return std::nullopt;
+        }
+        std::copy(path.begin(), path.end(), address.sun_path);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        std::optional<std::string> response;
+        if (::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0) {
+            const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+            ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+            response.emplace();
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                response->append(buffer, static_cast<size_t>(n));
+            }
+        }
+        ::close(fd);
+        return response;
+    }
+
+    void demonstrateMetrics() {
+        printHeader("Prometheus Metrics Demo");
+
+        InstanceId instance_id(18);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::BlobStore blobs(data_dir, instance_id);
+        if (!blobs.open()) {
+            printError("Failed to create blob directory");
+            return;
+        }
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        kvs_demo::SnapshotInfoCache snapshots(tracked, data_dir, instance_id);
+        kvs_demo::ResidentValueCache cache(kvs, blobs, 128 * 1024);
+
+        kvs_demo::MetricsRegistry registry;
+        kvs_demo::InstanceMetrics metrics(registry, data_dir, instance_id, &snapshots);
+        tracked.attach_metrics(&metrics);
+        const std::string labels = "instance=\"" + std::to_string(instance_id.id) + "\"";
+        registry.callbackCounter("kvs_cache_hits_total", "Large-value reads served from memory.", labels,
+                                 [&cache] { return static_cast<double>(cache.stats().hits.load()); });
+        registry.callbackCounter("kvs_cache_misses_total", "Large-value reads faulted in from disk.", labels,
+                                 [&cache] { return static_cast<double>(cache.stats().misses.load()); });
+
+        const std::string metrics_file = data_dir + "/kvs_metrics.prom";
+        const std::string metrics_socket = data_dir + "/kvs_metrics.sock";
+        kvs_demo::MetricsExporter file_exporter(registry, kvs_demo::MetricsExporter::Target::File, metrics_file,
+                                                std::chrono::milliseconds(100));
+        kvs_demo::MetricsExporter socket_exporter(registry, kvs_demo::MetricsExporter::Target::UnixSocket,
+                                                  metrics_socket);
+
+        printSubHeader("Running a workload on four threads");
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&tracked, t] {
+                for (int i = 0; i < 500; ++i) {
+                    std::string key = "worker_" + std::to_string(t) + "_" + std::to_string(i % 50);
+                    tracked.set_value(key, KvsValue(static_cast<int32_t>(i)));
+                    tracked.get_value(key);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (int i = 0; i < 3; ++i) {
+            tracked.set_value("generation", KvsValue(static_cast<int32_t>(i)));
+            tracked.flush();
+        }
+        for (int i = 0; i < 4; ++i) {
+            cache.set_value("tile_" + std::to_string(i), KvsValue(std::string(48 * 1024, static_cast<char>('a' + i))));
+        }
+        for (int i = 0; i < 4; ++i) {
+            for (int round = 0; round < 3; ++round) {
+                cache.get_value("tile_" + std::to_string(i));
+            }
+        }
+        printSuccess("4000 operations, 3 flushes and 12 large-value reads recorded");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        printSubHeader("Metrics file " + metrics_file);
+        std::ifstream file(metrics_file);
+        std::string line;
+        while (std::getline(file, line)) {
+            // The histogram buckets are left out here to keep the listing short
+            if (line.rfind("#", 0) != 0 && line.find("_bucket") == std::string::npos) {
+                std::cout << "  " << line << "\n";
+            }
+        }
+
+        printSubHeader("Scraping " + metrics_socket);
+        auto response = socket_exporter.running() ? scrapeUnixSocket(metrics_socket) : std::nullopt;
+        if (response && response->rfind("HTTP/1.0 200 OK", 0) == 0) {
+            printSuccess("Received " + std::to_string(response->size()) + " bytes; try: curl --unix-socket " +
+                         metrics_socket + " http://localhost/metrics");
+        } else {
+            printError("No answer on " + metrics_socket);
+        }
+        tracked.attach_metrics(nullptr);
+    }
+
+    void printMemoryStats(const kvs_demo::MemoryStats& stats) {
+        for (size_t type = 0; type < kvs_demo::MemoryStats::type_count; ++type) {
+            if (stats.by_type[type] != 0) {
+                std::cout << "  " << std::left << std::setw(8)
+                          << kvs_demo::MemoryStats::typeName(static_cast<KvsValue::Type>(type)) << std::right
+                          << std::setw(10) << stats.by_type[type] << " bytes\n";
+            }
+        }
+        std::cout << "  " << std::left << std::setw(8) << "keys" << std::right << std::setw(10) << stats.keys
+                  << " bytes\n";
+        std::cout << "  " << std::left << std::setw(8) << "index" << std::right << std::setw(10) << stats.index
+                  << " bytes\n";
+        std::cout << "  " << std::left << std::setw(8) << "slack" << std::right << std::setw(10) << stats.slack
+                  << " bytes\n";
+        std::cout << "  " << BOLD << std::left << std::setw(8) << "total" << std::right << std::setw(10)
+                  << stats.total() << " bytes" << RESET << " in " << stats.entries << " entries, "
+                  << stats.allocations << " allocations (modelled)\n";
+    }
+
+    void demonstrateMemoryStats() {
+        printHeader("Memory Accounting Demo");
+
+        InstanceId instance_id(19);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        kvs_demo::MemoryAccounting accounting(tracked);
+
+        printSubHeader("Storing counters, log lines, readings and device records");
+        for (int i = 0; i < 200; ++i) {
+            tracked.set_value("counter_" + std::to_string(i), KvsValue(static_cast<int32_t>(i)));
+        }
+        for (int i = 0; i < 50; ++i) {
+            tracked.set_value("log_line_" + std::to_string(i),
+                              KvsValue(std::string("2025-01-01T00:00:") + std::to_string(10 + i) +
+                                       " service started after " + std::to_string(i * 13) + " ms"));
+        }
+        for (int i = 0; i < 8; ++i) {
+            KvsValue::Array readings;
+            for (int j = 0; j < 64; ++j) {
+                readings.push_back(std::make_shared<KvsValue>(KvsValue(0.5 * j + i)));
+            }
+            tracked.set_value("readings_" + std::to_string(i), KvsValue(readings));
+        }
+        for (int i = 0; i < 16; ++i) {
+            KvsValue::Object device;
+            device["serial_number_long_field"] = std::make_shared<KvsValue>(KvsValue(std::string("SN-000") + std::to_string(i)));
+            device["online"] = std::make_shared<KvsValue>(KvsValue(i % 2 == 0));
+            device["firmware"] = std::make_shared<KvsValue>(KvsValue(static_cast<uint32_t>(0x020401)));
+            tracked.set_value("device_" + std::to_string(i), KvsValue(device));
+        }
+        printMemoryStats(accounting.memory_stats());
+
+        printSubHeader("Trimming: short log lines, readings removed");
+        size_t before = accounting.memory_stats().total();
+        for (int i = 0; i < 50; ++i) {
+            tracked.set_value("log_line_" + std::to_string(i), KvsValue(std::string("ok")));
+        }
+        for (int i = 0; i < 8; ++i) {
+            tracked.remove_key("readings_" + std::to_string(i));
+        }
+        kvs_demo::MemoryStats after = accounting.memory_stats();
+        printMemoryStats(after);
+        printSuccess("Freed " + std::to_string(before - after.total()) + " bytes, accounted per write");
+
+        printSubHeader("Checking the running totals against a recount of the same model");
+        auto start = std::chrono::steady_clock::now();
+        const int polls = 100000;
+        size_t sink = 0;
+        for (int i = 0; i < polls; ++i) {
+            sink += accounting.memory_stats().total();
+        }
+        auto poll_time = std::chrono::steady_clock::now() - start;
+        kvs_demo::MemoryAccounting recount(tracked);
+        if (recount.memory_stats().total() == after.total() && sink == after.total() * polls) {
+            printSuccess("Incremental totals match a recount of every value (both modelled estimates)");
+        } else {
+            printError("Incremental totals drifted from a recount");
+        }
+        std::cout << "  memory_stats(): " << GREEN
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(poll_time).count() / polls << " ns"
+                  << RESET << " per call, independent of the store size\n";
+    }
+
+    void printReplayStats(const kvs_demo::ReplayStats& stats) {
+        for (size_t op = 0; op < kvs_demo::recorded_op_count; ++op) {
+            if (stats.count[op] == 0) {
+                continue;
+            }
+            double average = std::chrono::duration<double, std::micro>(stats.time[op]).count() /
+                             static_cast<double>(stats.count[op]);
+            std::cout << "  " << std::left << std::setw(18) << kvs_demo::to_string(static_cast<kvs_demo::RecordedOp>(op))
+                      << std::right << std::setw(7) << stats.count[op] << " calls, " << std::fixed
+                      << std::setprecision(2) << std::setw(9) << average << " us avg\n";
+        }
+        std::cout << "  " << stats.operations << " operations in " << GREEN << std::setprecision(1)
+                  << std::chrono::duration<double, std::milli>(stats.elapsed).count() << " ms" << RESET
+                  << " (" << stats.errors << " returned an error)\n";
+    }
+
+    /// Build instance_id and drop whatever it held, as a replay target.
+    std::optional<Kvs> openEmptyInstance(InstanceId instance_id) {
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return std::nullopt;
+        }
+        Kvs kvs = std::move(builder_result.value());
+        if (!kvs.reset()) {
+            printError("Failed to reset instance " + std::to_string(instance_id.id));
+            return std::nullopt;
+        }
+        return std::optional<Kvs>(std::move(kvs));
+    }
+
+    void demonstrateRecordReplay() {
+        printHeader("Record and Replay Demo");
+
+        InstanceId instance_id(24);
+        auto recorded_kvs = openEmptyInstance(instance_id);
+        if (!recorded_kvs) {
+            return;
+        }
+        kvs_demo::TrackedKvs tracked(*recorded_kvs, instance_id);
+        const std::string trace_path = data_dir + "/kvs_24_ops.rec";
+
+        printSubHeader("Recording three bursts of traffic");
+        {
+            kvs_demo::OperationRecorder recorder(trace_path, instance_id);
+            tracked.attach_recorder(&recorder);
+            for (int burst = 0; burst < 3; ++burst) {
+                for (int i = 0; i < 300; ++i) {
+                    std::string key = "sensor_" + std::to_string(i % 40);
+                    if (i % 3 == 0) {
+                        KvsValue::Object reading;
+                        reading["value"] = std::make_shared<KvsValue>(KvsValue(0.25 * i + burst));
+                        reading["unit"] = std::make_shared<KvsValue>(KvsValue(std::string("degC")));
+                        tracked.set_value(key, KvsValue(reading));
+                    } else {
+                        tracked.set_value(key, KvsValue(static_cast<int32_t>(burst * 1000 + i)));
+                    }
+                    tracked.get_value(key);
+                    tracked.get_value("sensor_" + std::to_string((i * 7) % 50));
+                }
+                tracked.remove_key("sensor_" + std::to_string(burst));
+                tracked.flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(40));
+            }
+            tracked.attach_recorder(nullptr);
+            if (!recorder.sync()) {
+                printError("Failed to write " + trace_path);
+                return;
+            }
+            printSuccess("Recorded " + std::to_string(recorder.recorded()) + " calls to " + trace_path);
+        }
+
+        auto trace = kvs_demo::OperationTrace::load(trace_path);
+        if (!trace) {
+            printError("Failed to decode " + trace_path);
+            return;
+        }
+
+        printSubHeader("Replaying as fast as possible into instance 25");
+        auto replayed_kvs = openEmptyInstance(InstanceId(25));
+        if (!replayed_kvs) {
+            return;
+        }
+        kvs_demo::ReplayStats fast = kvs_demo::replay(*trace, *replayed_kvs, kvs_demo::ReplayPacing::AsFastAsPossible);
+        printReplayStats(fast);
+
+        size_t matching = 0;
+        auto keys_result = recorded_kvs->get_all_keys();
+        auto replayed_keys = replayed_kvs->get_all_keys();
+        if (keys_result && replayed_keys && keys_result.value().size() == replayed_keys.value().size()) {
+            for (const auto& key : keys_result.value()) {
+                auto original = recorded_kvs->get_value(key);
+                auto copy = replayed_kvs->get_value(key);
+                if (original && copy && kvs_demo::valuesEqual(original.value(), copy.value())) {
+                    ++matching;
+                }
+            }
+        }
+        if (keys_result && matching == keys_result.value().size()) {
+            printSuccess("Replayed contents match the recorded instance (" + std::to_string(matching) + " keys)");
+        } else {
+            printError("Replayed contents differ from the recorded instance");
+        }
+
+        printSubHeader("Replaying at the recorded pace");
+        replayed_kvs->reset();
+        kvs_demo::ReplayStats paced = kvs_demo::replay(*trace, *replayed_kvs, kvs_demo::ReplayPacing::Recorded);
+        std::cout << "  recorded span: " << std::chrono::duration_cast<std::chrono::milliseconds>(trace->duration()).count()
+                  << " ms, replay took " << GREEN
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(paced.elapsed).count() << " ms" << RESET
+                  << "\n";
+        printInfo("Replay it against another build: kvs_demo " + data_dir + " --replay " + trace_path + " [--timed]");
+    }
+
+    void demonstrateSnapshots() {
+        printHeader("Snapshot Management Demo");
+
+        auto builder_result = KvsBuilder(InstanceId(3))
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, InstanceId(3));
+        kvs_demo::SnapshotInfoCache snapshots(tracked, data_dir, InstanceId(3));
+
+        printSubHeader("Setting up initial data");
+        kvs.set_value("version", KvsValue(static_cast<int32_t>(1)));
+        kvs.set_value("config", KvsValue(std::string("initial")));
+        tracked.flush();
+        printSuccess("Initial data created");
+
+        auto max_snapshots = snapshots.snapshot_max_count();
+        printInfo("Maximum snapshots allowed: " + std::to_string(max_snapshots));
+
+        printSubHeader("Creating snapshots with data changes");
+
+        for (int i = 2; i <= 4; ++i) {
+            kvs.set_value("version", KvsValue(static_cast<int32_t>(i)));
+            kvs.set_value("config", KvsValue(std::string("config_v") + std::to_string(i)));
+
+            auto flush_result = tracked.flush();
+            if (flush_result) {
+                // Answered from the cache, without looking at the snapshot files
+                printSuccess("Created snapshot " + std::to_string(i) + " (total: " +
+                           std::to_string(snapshots.snapshot_count()) + ")");
+            }
+        }
+
+        printSubHeader("Snapshot metadata");
+        auto now = std::chrono::system_clock::now();
+        for (const auto& info : snapshots.snapshot_info()) {
+            auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - info.written).count();
+            std::cout << "  Snapshot " << info.id << ": " << info.json_size << " bytes, checksum 0x" << std::hex
+                      << std::setw(8) << std::setfill('0') << info.checksum << std::dec << std::setfill(' ')
+                      << ", written " << age << " ms ago\n";
+        }
+
+        printSubHeader("Current state before restoration");
+        auto current_version = kvs.get_value("version");
+        auto current_config = kvs.get_value("config");
+        if (current_version && current_config) {
+            printKvsValue("version", current_version.value());
+            printKvsValue("config", current_config.value());
+        }
+
+        printSubHeader("Restoring from snapshot 1");
+        auto restore_result = tracked.snapshot_restore(SnapshotId(1));
+        if (restore_result) {
+            printSuccess("Successfully restored from snapshot 1");
+
+            auto restored_version = kvs.get_value("version");
+            auto restored_config = kvs.get_value("config");
+            if (restored_version && restored_config) {
+                printKvsValue("version", restored_version.value());
+                printKvsValue("config", restored_config.value());
+            }
+        } else {
+            printError("Failed to restore from snapshot 1");
+        }
+    }
+
+    void createDefaultsFile(InstanceId instance_id) {
+        std::string defaults_file_path = kvs_demo::storePath(data_dir, instance_id.id, "default.json");
+        std::string defaults_hash_path = kvs_demo::storePath(data_dir, instance_id.id, "default.hash");
+
+        // Create JSON in flat format (like C++ tests)
+        std::string defaults_content = R"({
+    "theme": {
+        "t": "str",
+        "v": "dark"
+    },
+    "language": {
+        "t": "str",
+        "v": "en"
+    },
+    "timeout": {
+        "t": "i32",
+        "v": 30
+    },
+    "auto_save": {
+        "t": "bool",
+        "v": true
+    },
+    "max_connections": {
+        "t": "i32",
+        "v": 100
+    }
+})";
+
+        // Create JSON and hash file using persistency's Adler-32 implementation
+        kvs_demo::SyscallCounter counter;
+        if (!kvs_demo::writeStoreFilePair(defaults_file_path, defaults_content, counter)) {
+            printError("Failed to create defaults files: " + defaults_file_path + ", " + defaults_hash_path);
+        }
+    }
+
+    void demonstrateDefaults() {
+        printHeader("Default Values Demo");
+
+        InstanceId instance_id(5);
+
+        printSubHeader("Creating defaults file manually (as required by persistency)");
+        createDefaultsFile(instance_id);
+        printSuccess("Defaults file created manually");
+
+        printSubHeader("Creating KVS with required defaults");
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(true)   // Require defaults file
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance with defaults - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        printSuccess("KVS instance created with defaults");
+
+        printSubHeader("Reading default values");
+
+        std::vector<std::string> default_keys = {"theme", "language", "timeout", "auto_save", "max_connections"};
+        for (const auto& key : default_keys) {
+            auto default_result = kvs.get_default_value(key);
+            if (default_result) {
+                std::cout << "  Default ";
+                printKvsValue(key, default_result.value());
+            }
+        }
+
+        printSubHeader("Overriding some defaults");
+        kvs.set_value("theme", KvsValue(std::string("light")));
+        kvs.set_value("timeout", KvsValue(static_cast<int32_t>(60)));
+        printSuccess("Overrode 'theme' and 'timeout' values");
+
+        printSubHeader("Current values (mix of defaults and overrides)");
+        for (const auto& key : default_keys) {
+            auto value_result = kvs.get_value(key);
+            if (value_result) {
+                auto is_default = !kvs.key_exists(key).value_or(false);
+                std::cout << "  " << (is_default ? "(default) " : "(custom)  ");
+                printKvsValue(key, value_result.value());
+            }
+        }
+
+        printSubHeader("Resetting a key to default");
+        auto reset_result = kvs.reset_key("theme");
+        if (reset_result) {
+            printSuccess("Reset 'theme' to default value");
+            auto value_result = kvs.get_value("theme");
+            if (value_result) {
+                std::cout << "  ";
+                printKvsValue("theme", value_result.value());
+            }
+        }
+
+        kvs.flush();
+        printSuccess("Configuration saved with defaults");
+    }
+
+    void demonstrateReset() {
+        printHeader("Reset Operations Demo");
+
+
+        auto builder_result = KvsBuilder(InstanceId(6))
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+
+        printSubHeader("Adding test data");
+        kvs.set_value("test1", KvsValue(std::string("value1")));
+        kvs.set_value("test2", KvsValue(static_cast<int32_t>(42)));
+        kvs.set_value("test3", KvsValue(true));
+
+        auto initial_count = kvs.get_all_keys().value_or(std::vector<std::string>{}).size();
+        printSuccess("Added " + std::to_string(initial_count) + " test entries");
+
+        printSubHeader("Performing complete reset");
+        auto reset_result = kvs.reset();
+        if (reset_result) {
+            auto final_count = kvs.get_all_keys().value_or(std::vector<std::string>{}).size();
+            printSuccess("Reset complete - " + std::to_string(final_count) + " entries remaining");
+
+            if (final_count == 0) {
+                printSuccess("KVS is now empty");
+            }
+        } else {
+            printError("Reset failed");
+        }
+    }
+
+    void benchmarkDurability() {
+        printHeader("Flush Latency per Durability Policy");
+
+        const int flush_count = 50;
+        printInfo("Flushing " + std::to_string(flush_count) + " times per policy into '" + data_dir + "'");
+        std::cout << "\n  " << BOLD << std::left << std::setw(12) << "policy"
+                  << std::right << std::setw(12) << "mean (us)" << std::setw(12) << "p50 (us)"
+                  << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)" << RESET << "\n";
+
+        size_t instance = 10;
+        for (DurabilityPolicy policy : ALL_DURABILITY_POLICIES) {
+            InstanceId instance_id(instance++);
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(false)
+                .dir(std::string(data_dir))
+                .build();
+
+            if (!builder_result) {
+                printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+                return;
+            }
+
+            Kvs kvs = std::move(builder_result.value());
+            DurableFlusher flusher(data_dir, instance_id, policy);
+            kvs.set_value("payload", KvsValue(std::string(256, 'x')));
+
+            std::vector<double> latencies;
+            for (int i = 0; i < flush_count; ++i) {
+                kvs.set_value("counter", KvsValue(static_cast<int64_t>(i)));
+                auto start = std::chrono::steady_clock::now();
+                bool flushed = flusher.flush(kvs);
+                auto end = std::chrono::steady_clock::now();
+                if (!flushed) {
+                    printError(std::string("Flush failed with policy '") + kvs_demo::to_string(policy) + "'");
+                    break;
+                }
+                latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            }
+            if (latencies.empty()) {
+                continue;
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            double mean = 0.0;
+            for (double latency : latencies) {
+                mean += latency;
+            }
+            mean /= static_cast<double>(latencies.size());
+
+            std::cout << "  " << std::left << std::setw(12) << kvs_demo::to_string(policy) << std::right
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << mean
+                      << std::setw(12) << latencies[latencies.size() / 2]
+                      << std::setw(12) << latencies[(latencies.size() * 99) / 100]
+                      << std::setw(12) << latencies.back() << "\n";
+        }
+
+        std::cout << "\n";
+        printInfo("'deferred' pays its sync in the background, once per period");
+    }
+
+    void benchmarkStoreFormat() {
+        printHeader("Two-File vs Single-File Store Format");
+
+        InstanceId instance_id(30);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        for (int i = 0; i < 32; ++i) {
+            kvs.set_value("key_" + std::to_string(i), KvsValue(std::string(64, static_cast<char>('a' + i % 26))));
+        }
+        kvs.flush();
+
+        std::string prefix = kvs_demo::storePath(data_dir, instance_id.id, "");
+        auto json = kvs_demo::readStoreFile(prefix + "0.json");
+        if (!json) {
+            printError("Failed to read back " + prefix + "0.json");
+            return;
+        }
+        printSuccess("Verified the library's two-file store (" + std::to_string(json->size()) + " bytes)");
+
+        const int write_count = 20;
+        std::cout << "\n  " << BOLD << std::left << std::setw(14) << "layout"
+                  << std::right << std::setw(8) << "files" << std::setw(16) << "syscalls/flush"
+                  << std::setw(12) << "mean (us)" << std::setw(10) << "verify" << RESET << "\n";
+
+        struct Layout {
+            const char* name;
+            size_t files;
+            std::string path;
+            bool (*write)(const std::string&, const std::string&, kvs_demo::SyscallCounter&);
+        };
+        const Layout layouts[] = {
+            {"two-file", 2, prefix + "export.json", kvs_demo::writeStoreFilePair},
+            {"single-file", 1, prefix + "export.kvsf", kvs_demo::writeStoreFile},
+        };
+
+        for (const auto& layout : layouts) {
+            kvs_demo::SyscallCounter counter;
+            auto start = std::chrono::steady_clock::now();
+            bool ok = true;
+            for (int i = 0; i < write_count && ok; ++i) {
+                ok = layout.write(layout.path, *json, counter);
+            }
+            auto end = std::chrono::steady_clock::now();
+            if (!ok) {
+                printError(std::string("Failed to write ") + layout.name + " layout");
+                continue;
+            }
+
+            auto read_back = kvs_demo::readStoreFile(layout.path);
+            bool verified = read_back && *read_back == *json;
+            double mean = std::chrono::duration<double, std::micro>(end - start).count() / write_count;
+            std::cout << "  " << std::left << std::setw(14) << layout.name << std::right
+                      << std::setw(8) << layout.files
+                      << std::setw(16) << counter.total() / write_count
+                      << std::fixed << std::setprecision(1) << std::setw(12) << mean
+                      << (verified ? GREEN : RED) << std::setw(10) << (verified ? "ok" : "FAILED") << RESET << "\n";
+        }
+        std::cout << "\n";
+        printInfo("Both layouts are synced and renamed atomically; readStoreFile() accepts either");
+    }
+
+    void benchmarkRecovery() {
+        printHeader("Snapshot Chain vs A/B Slot Recovery");
+
+        InstanceId instance_id(31);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        std::string prefix = kvs_demo::storePath(data_dir, instance_id.id, "");
+        kvs_demo::AbSlotStore slots(data_dir, instance_id);
+        if (!slots.open()) {
+            printError("Failed to open A/B slot files for " + prefix);
+            return;
+        }
+
+        size_t generations = kvs.snapshot_max_count() + 1;
+        for (size_t i = 0; i < generations; ++i) {
+            kvs.set_value("generation", KvsValue(static_cast<uint64_t>(i)));
+            kvs.set_value("payload", KvsValue(std::string(4096, static_cast<char>('a' + i % 26))));
+            kvs.flush();
+            auto json = kvs_demo::readStoreFile(prefix + "0.json");
+            if (!json || !slots.commit(*json)) {
+                printError("Failed to mirror generation " + std::to_string(i) + " into the A/B slots");
+                return;
+            }
+        }
+        printSuccess("Wrote " + std::to_string(generations) + " generations, commit sequence " +
+                     std::to_string(slots.sequence()) + ", active slot " + slots.activeSlot());
+
+        const int rounds = 50;
+        auto start = std::chrono::steady_clock::now();
+        size_t verified = 0;
+        for (int round = 0; round < rounds; ++round) {
+            // Worst case for the file chain: every generation is probed and re-hashed
+            for (size_t i = 0; i < generations; ++i) {
+                if (kvs_demo::readStoreFile(prefix + std::to_string(i) + ".json")) {
+                    ++verified;
+                }
+            }
+        }
+        auto chain_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        size_t recovered = 0;
+        for (int round = 0; round < rounds; ++round) {
+            kvs_demo::AbSlotStore reopened(data_dir, instance_id);
+            if (reopened.open() && reopened.recover()) {
+                ++recovered;
+            }
+        }
+        auto slot_time = std::chrono::steady_clock::now() - start;
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(22) << "recovery"
+                  << std::right << std::setw(14) << "files read" << std::setw(14) << "mean (us)" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(22) << "snapshot chain probe" << std::right
+                  << std::setw(14) << 2 * generations << std::fixed << std::setprecision(1)
+                  << std::setw(14) << std::chrono::duration<double, std::micro>(chain_time).count() / rounds << "\n";
+        std::cout << "  " << std::left << std::setw(22) << "A/B commit record" << std::right
+                  << std::setw(14) << 2 << std::fixed << std::setprecision(1)
+                  << std::setw(14) << std::chrono::duration<double, std::micro>(slot_time).count() / rounds << "\n\n";
+
+        if (recovered == static_cast<size_t>(rounds) && verified == generations * rounds) {
+            printSuccess("All recoveries verified");
+        } else {
+            printError("Some recoveries failed verification");
+        }
+    }
+
+    void benchmarkPersistentObject() {
+        printHeader("Copying vs Sharing Large Objects");
+
+        const size_t entry_count = 10000;
+        const int rounds = 100;
+        KvsValue::Object object;
+        for (size_t i = 0; i < entry_count; ++i) {
+            object.emplace("sensor_" + std::to_string(i), std::make_shared<KvsValue>(KvsValue(static_cast<double>(i))));
+        }
+        kvs_demo::PersistentObject persistent = kvs_demo::toPersistent(object);
+        printSuccess("Built an object with " + std::to_string(entry_count) + " entries in both representations");
+
+        // Each round takes a snapshot and then changes one entry of the live copy
+        auto start = std::chrono::steady_clock::now();
+        size_t checksum = 0;
+        for (int round = 0; round < rounds; ++round) {
+            KvsValue::Object snapshot = object;
+            object["sensor_0"] = std::make_shared<KvsValue>(KvsValue(static_cast<double>(round)));
+            checksum += snapshot.size();
+        }
+        auto copy_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        std::vector<kvs_demo::PersistentObject> snapshots;
+        for (int round = 0; round < rounds; ++round) {
+            snapshots.push_back(persistent);
+            persistent = persistent.set("sensor_0", std::make_shared<const KvsValue>(KvsValue(static_cast<double>(round))));
+            checksum += snapshots.back().size();
+        }
+        auto share_time = std::chrono::steady_clock::now() - start;
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(26) << "snapshot + update"
+                  << std::right << std::setw(14) << "mean (us)" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(26) << "KvsValue::Object copy" << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14)
+                  << std::chrono::duration<double, std::micro>(copy_time).count() / rounds << "\n";
+        std::cout << "  " << std::left << std::setw(26) << "PersistentObject" << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14)
+                  << std::chrono::duration<double, std::micro>(share_time).count() / rounds << "\n\n";
+
+        // Every snapshot must still see the value it was taken with
+        bool isolated = checksum == 2 * entry_count * rounds;
+        const kvs_demo::ValuePtr* first = snapshots.front().find("sensor_0");
+        isolated = isolated && first && std::get<double>((*first)->getValue()) == 0.0;
+        for (int round = 1; round < rounds && isolated; ++round) {
+            const kvs_demo::ValuePtr* value = snapshots[round].find("sensor_0");
+            isolated = value && std::get<double>((*value)->getValue()) == static_cast<double>(round - 1);
+        }
+        if (isolated && kvs_demo::toObject(persistent).size() == entry_count) {
+            printSuccess("All " + std::to_string(rounds) + " snapshots unchanged by later updates");
+        } else {
+            printError("A snapshot observed a later update");
+        }
+    }
+
+    static size_t countNodes(const std::shared_ptr<KvsValue>& value, std::unordered_set<const KvsValue*>& seen) {
+        if (!value || !seen.insert(value.get()).second) {
+            return 0;
+        }
+        size_t count = 1;
+        if (value->getType() == KvsValue::Type::Array) {
+            for (const auto& element : std::get<KvsValue::Array>(value->getValue())) {
+                count += countNodes(element, seen);
+            }
+        } else if (value->getType() == KvsValue::Type::Object) {
+            for (const auto& [key, element] : std::get<KvsValue::Object>(value->getValue())) {
+                count += countNodes(element, seen);
+            }
+        }
+        return count;
+    }
+
+    void benchmarkDeduplication() {
+        printHeader("Deduplicating Repeated Configurations");
+
+        InstanceId instance_id(32);
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(false)
+            .dir(std::string(data_dir))
+            .build();
+
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        const size_t device_count = 1000;
+        const char* locations[] = {"Room A", "Room B", "Hall", "Lab"};
+
+        // Devices differ only in their id; settings come in a handful of variants
+        KvsValue::Object fleet;
+        kvs_demo::ValueInterner interner;
+        for (size_t i = 0; i < device_count; ++i) {
+            KvsValue::Array filters;
+            for (int f = 0; f < 4; ++f) {
+                filters.push_back(std::make_shared<KvsValue>(KvsValue(static_cast<double>(f + i % 3))));
+            }
+            KvsValue::Object settings;
+            settings["sample_rate"] = std::make_shared<KvsValue>(KvsValue(static_cast<int32_t>(100 * (1 + i % 2))));
+            settings["filters"] = std::make_shared<KvsValue>(KvsValue(filters));
+            settings["firmware_channel"] = std::make_shared<KvsValue>(KvsValue(std::string("stable-2025.1")));
+
+            KvsValue::Object config;
+            config["id"] = std::make_shared<KvsValue>(KvsValue(static_cast<uint64_t>(i)));
+            config["enabled"] = std::make_shared<KvsValue>(KvsValue(i % 5 != 0));
+            config["location"] = std::make_shared<KvsValue>(KvsValue(std::string(locations[i % 4])));
+            config["settings"] = std::make_shared<KvsValue>(KvsValue(settings));
+
+            std::string key = "device_" + std::to_string(i);
+            KvsValue value(config);
+            fleet[key] = std::make_shared<KvsValue>(value);
+            kvs.set_value(key, interner.internChildren(value));
+        }
+        kvs.flush();
+
+        std::unordered_set<const KvsValue*> seen;
+        size_t plain_nodes = countNodes(std::make_shared<KvsValue>(KvsValue(fleet)), seen);
+        KvsValue::Object interned_fleet;
+        auto keys_result = kvs.get_all_keys();
+        if (keys_result) {
+            for (const auto& key : keys_result.value()) {
+                auto value_result = kvs.get_value(key);
+                if (value_result) {
+                    interned_fleet[key] = std::make_shared<KvsValue>(value_result.value());
+                }
+            }
+        }
+        seen.clear();
+        size_t interned_nodes = countNodes(std::make_shared<KvsValue>(KvsValue(interned_fleet)), seen);
+
+        std::string plain;
+        std::string shared;
+        kvs_demo::encodeValue(KvsValue(fleet), plain);
+        auto start = std::chrono::steady_clock::now();
+        kvs_demo::encodeValueShared(KvsValue(interned_fleet), shared);
+        auto encode_time = std::chrono::steady_clock::now() - start;
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(24) << "representation"
+                  << std::right << std::setw(14) << "nodes" << std::setw(16) << "binary bytes" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(24) << "plain" << std::right
+                  << std::setw(14) << plain_nodes << std::setw(16) << plain.size() << "\n";
+        std::cout << "  " << std::left << std::setw(24) << "interned + back-refs" << std::right
+                  << std::setw(14) << interned_nodes << std::setw(16) << shared.size() << "\n\n";
+        printInfo("Interner: " + std::to_string(interner.size()) + " canonical nodes, " +
+                  std::to_string(interner.stats().hits) + " of " + std::to_string(interner.stats().lookups) +
+                  " lookups hit; shared encoding took " +
+                  std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(encode_time).count()) + " us");
+
+        auto decoded = kvs_demo::decodeValue(reinterpret_cast<const uint8_t*>(shared.data()), shared.size());
+        if (decoded && kvs_demo::valuesEqual(*decoded, KvsValue(fleet))) {
+            printSuccess("Shared encoding decodes to the original " + std::to_string(device_count) + " devices");
+        } else {
+            printError("Shared encoding did not round-trip");
+        }
+    }
+
+    void benchmarkWarmStart() {
+        printHeader("Warm Start from a Mapped Image");
+
+        InstanceId instance_id(33);
+        const int key_count = 5000;
+        {
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(false)
+                .dir(std::string(data_dir))
+                .build();
+
+            if (!builder_result) {
+                printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+                return;
+            }
+
+            Kvs kvs = std::move(builder_result.value());
+            for (int i = 0; i < key_count; ++i) {
+                KvsValue::Object config;
+                config["id"] = std::make_shared<KvsValue>(KvsValue(static_cast<int32_t>(i)));
+                config["label"] = std::make_shared<KvsValue>(KvsValue("sensor channel " + std::to_string(i)));
+                config["gain"] = std::make_shared<KvsValue>(KvsValue(1.0 + 0.001 * i));
+                kvs.set_value("channel_" + std::to_string(i), KvsValue(config));
+            }
+            if (!kvs.flush() || !kvs_demo::WarmImage::write(kvs, data_dir, instance_id)) {
+                printError("Failed to write the store and its warm image");
+                return;
+            }
+        }
+
+        const std::string probe_key = "channel_" + std::to_string(key_count / 2);
+        auto start = std::chrono::steady_clock::now();
+        auto builder_result = KvsBuilder(instance_id)
+            .need_defaults_flag(false)
+            .need_kvs_flag(true)
+            .dir(std::string(data_dir))
+            .build();
+        std::optional<KvsValue> cold_value;
+        if (builder_result) {
+            auto value_result = builder_result.value().get_value(probe_key);
+            if (value_result) {
+                cold_value = value_result.value();
+            }
+        }
+        auto cold_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        auto image = kvs_demo::WarmImage::open(data_dir, instance_id);
+        auto warm_value = image ? image->get_value(probe_key) : std::nullopt;
+        auto warm_time = std::chrono::steady_clock::now() - start;
+
+        auto micros = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        };
+        std::cout << "\n  " << BOLD << std::left << std::setw(28) << "startup path" << std::right
+                  << std::setw(18) << "first read (us)" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "KvsBuilder::build()" << std::right
+                  << std::setw(18) << micros(cold_time) << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "WarmImage::open()" << std::right
+                  << std::setw(18) << micros(warm_time) << "\n\n";
+
+        if (cold_value && warm_value && kvs_demo::valuesEqual(*cold_value, *warm_value)) {
+            printSuccess("Image of " + std::to_string(image->size()) + " keys matches the JSON store");
+        } else {
+            printError("Warm image and JSON store disagree");
+        }
+
+        if (builder_result) {
+            Kvs& kvs = builder_result.value();
+            kvs.set_value(probe_key, KvsValue(std::string("changed")));
+            kvs.flush();
+            if (!kvs_demo::WarmImage::open(data_dir, instance_id)) {
+                printSuccess("Image refused after the store was flushed again; startup falls back to JSON");
+            } else {
+                printError("Stale image was accepted");
+            }
+        }
+    }
+
+    void benchmarkParallelStartup() {
+        printHeader("Parallel Startup of Many Instances");
+
+        // One instance per subsystem, with store sizes that differ a lot
+        std::vector<InstanceId> instance_ids;
+        for (size_t i = 0; i < 16; ++i) {
+            InstanceId instance_id(34 + i);
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(false)
+                .dir(std::string(data_dir))
+                .build();
+
+            if (!builder_result) {
+                printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+                return;
+            }
+
+            Kvs kvs = std::move(builder_result.value());
+            size_t key_count = (i % 4 == 0) ? 4000 : 250;
+            for (size_t k = 0; k < key_count; ++k) {
+                kvs.set_value("param_" + std::to_string(k), KvsValue("subsystem " + std::to_string(i) + " value " + std::to_string(k)));
+            }
+            kvs.flush();
+            instance_ids.push_back(instance_id);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& instance_id : instance_ids) {
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(true)
+                .dir(std::string(data_dir))
+                .build();
+            if (!builder_result) {
+                printError("Sequential build failed for instance " + std::to_string(instance_id.id));
+                return;
+            }
+        }
+        auto sequential_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        auto built = kvs_demo::buildAll(instance_ids, data_dir, true);
+        auto parallel_time = std::chrono::steady_clock::now() - start;
+        if (!built) {
+            printError("buildAll() refused the instance list");
+            return;
+        }
+        const auto& loads = *built;
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(12) << "instance" << std::right
+                  << std::setw(10) << "worker" << std::setw(14) << "load (us)" << RESET << "\n";
+        size_t failed = 0;
+        for (const auto& load : loads) {
+            failed += load.kvs ? 0 : 1;
+            std::cout << "  " << std::left << std::setw(12) << load.instance_id.id << std::right
+                      << std::setw(10) << load.worker << std::setw(14) << load.load_time.count()
+                      << (load.kvs ? "" : "  (failed)") << "\n";
+        }
+
+        auto micros = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        };
+        std::cout << "\n  Sequential builds: " << YELLOW << micros(sequential_time) << " us" << RESET
+                  << ", buildAll(): " << GREEN << micros(parallel_time) << " us" << RESET << " on "
+                  << std::max(1u, std::thread::hardware_concurrency()) << " hardware threads\n\n";
+        if (failed == 0) {
+            printSuccess("All " + std::to_string(loads.size()) + " instances loaded in parallel");
+        } else {
+            printError(std::to_string(failed) + " instances failed to load");
+        }
+    }
+
+    void benchmarkManifest() {
+        printHeader("Directory Manifest Instead of Probing");
+
+        kvs_demo::DirectoryManifest manifest(data_dir);
+        std::vector<InstanceId> instance_ids;
+        std::vector<size_t> expected_counts;
+        for (size_t i = 0; i < 8; ++i) {
+            InstanceId instance_id(50 + i);
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(false)
+                .dir(std::string(data_dir))
+                .build();
+
+            if (!builder_result) {
+                printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+                return;
+            }
+
+            Kvs kvs = std::move(builder_result.value());
+            for (size_t generation = 0; generation <= i % 5; ++generation) {
+                kvs.set_value("generation", KvsValue(static_cast<int32_t>(generation)));
+                if (!manifest.flush(kvs, instance_id)) {
+                    printError("Failed to flush instance " + std::to_string(instance_id.id));
+                    return;
+                }
+            }
+            auto count = kvs.snapshot_count();
+            instance_ids.push_back(instance_id);
+            expected_counts.push_back(count ? count.value() : 0);
+        }
+
+        // What startup does without a manifest: probe every possible generation of every instance
+        const int rounds = 200;
+        size_t stat_calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& instance_id : instance_ids) {
+                for (size_t generation = 0; generation <= 3; ++generation) {
+                    struct stat info;
+                    std::string prefix = kvs_demo::generationPath(data_dir, instance_id.id, generation);
+                    ::stat((prefix + ".json").c_str(), &info);
+                    ::stat((prefix + ".hash").c_str(), &info);
+                    stat_calls += 2;
+                }
+            }
+        }
+        auto probe_time = std::chrono::steady_clock::now() - start;
+
+        bool consistent = true;
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            kvs_demo::DirectoryManifest reader(data_dir);
+            consistent = reader.load() && consistent;
+            for (size_t i = 0; i < instance_ids.size(); ++i) {
+                consistent = reader.snapshot_count(instance_ids[i]) == expected_counts[i] && consistent;
+            }
+        }
+        auto manifest_time = std::chrono::steady_clock::now() - start;
+
+        auto micros = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        };
+        std::cout << "\n  " << BOLD << std::left << std::setw(28) << "startup lookup" << std::right
+                  << std::setw(16) << "syscalls/round" << std::setw(14) << "us/round" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "probe .json/.hash files" << std::right
+                  << std::setw(16) << stat_calls / rounds << std::setw(14) << micros(probe_time) / rounds << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "read kvs_manifest.bin" << std::right
+                  << std::setw(16) << 3 << std::setw(14) << micros(manifest_time) / rounds << "\n\n";
+
+        kvs_demo::DirectoryManifest rebuilt(data_dir);
+        consistent = rebuilt.rebuild() && consistent;
+        for (size_t i = 0; i < instance_ids.size(); ++i) {
+            consistent = rebuilt.snapshot_count(instance_ids[i]) == expected_counts[i] && consistent;
+        }
+        if (consistent) {
+            printSuccess("Manifest snapshot counts match Kvs::snapshot_count() for " +
+                         std::to_string(instance_ids.size()) + " instances (" +
+                         std::to_string(rebuilt.instances().size()) + " instances in the directory)");
+        } else {
+            printError("Manifest disagrees with the instance files");
+        }
+    }
+
+    void benchmarkProbeOverhead() {
+        printHeader("USDT Tracepoints, Disabled Overhead");
+
+        InstanceId instance_id(58);
+        auto builder_result = kvs_demo::tracedBuild(instance_id, data_dir, false, false);
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::TrackedKvs tracked(kvs, instance_id);
+        const int ops = 200000;
+        std::vector<std::string> keys;
+        for (int i = 0; i < 64; ++i) {
+            keys.push_back("probe_key_" + std::to_string(i));
+        }
+
+        // Same operations straight on Kvs and through the probed wrapper
+        auto measure = [&](auto&& set_value, auto&& get_value) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < ops; ++i) {
+                const std::string& key = keys[i % keys.size()];
+                set_value(key, KvsValue(static_cast<int32_t>(i)));
+                get_value(key);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (2.0 * ops);
+        };
+        double plain_ns = measure([&](const std::string& key, const KvsValue& value) { kvs.set_value(key, value); },
+                                  [&](const std::string& key) { kvs.get_value(key); });
+        double probed_ns = measure([&](const std::string& key, const KvsValue& value) { tracked.set_value(key, value); },
+                                   [&](const std::string& key) { tracked.get_value(key); });
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(28) << "path" << std::right
+                  << std::setw(14) << "ns/op" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "Kvs" << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << plain_ns << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "TrackedKvs, probes idle" << std::right
+                  << std::setw(14) << probed_ns << "\n\n";
+
+        if (kvs_demo::probes_compiled_in) {
+            printSuccess("USDT probes compiled in (provider kvs_demo); list them with:");
+            std::cout << "    bpftrace -l 'usdt:./kvs_demo:kvs_demo:*'\n";
+            std::cout << "  Latency histogram of set_value per instance, while the demo runs:\n";
+            std::cout << "    bpftrace -e 'usdt:./kvs_demo:kvs_demo:set_value { @ns[arg0] = hist(arg2); }'\n";
+            std::cout << "  Or with perf:\n";
+            std::cout << "    perf buildid-cache --add ./kvs_demo && perf probe sdt_kvs_demo:flush\n";
+            std::cout << "    perf record -e sdt_kvs_demo:flush -aR\n";
+        } else {
+            printInfo("<sys/sdt.h> was not found at build time, so the probes compiled to nothing");
+            printInfo("Install systemtap-sdt-devel and rebuild to enable them");
+        }
+    }
+
+    void benchmarkTracing() {
+        printHeader("Chrome Trace Export of Flush Spans");
+
+        InstanceId instance_id(59);
+        auto builder_result = kvs_demo::tracedBuild(instance_id, data_dir, false, false);
+        if (!builder_result) {
+            printError("Failed to create KVS instance - Error code: " + std::to_string(static_cast<int>(static_cast<ErrorCode>(*builder_result.error()))));
+            return;
+        }
+
+        Kvs kvs = std::move(builder_result.value());
+        kvs_demo::DurableFlusher flusher(data_dir, instance_id, kvs_demo::DurabilityPolicy::Full);
+        std::string export_path = data_dir + "/kvs_59_export.json";
+        const int flush_count = 50;
+
+        // One round: a batch of writes, a durable flush, and an export through the demo's own writer
+        auto run = [&]() {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < flush_count; ++i) {
+                for (int k = 0; k < 100; ++k) {
+                    kvs.set_value("reading_" + std::to_string(k), KvsValue(static_cast<double>(i * k)));
+                }
+                flusher.flush(kvs);
+                auto json = kvs_demo::readStoreFile(data_dir + "/kvs_59_0.json");
+                kvs_demo::SyscallCounter counter;
+                if (json) {
+                    kvs_demo::writeStoreFilePair(export_path, *json, counter);
+                }
+            }
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() /
+                   static_cast<double>(flush_count);
+        };
+
+        // Keep an already installed (--trace) sink; otherwise use a local one for this run
+        kvs_demo::TraceSink* outer = kvs_demo::TraceSink::installed();
+        kvs_demo::TraceSink::install(nullptr);
+        double untraced_us = run();
+        kvs_demo::TraceSink local_sink(4096);
+        kvs_demo::TraceSink* sink = outer != nullptr ? outer : &local_sink;
+        uint64_t before = sink->recorded();
+        kvs_demo::TraceSink::install(sink);
+        double traced_us = run();
+        kvs_demo::TraceSink::install(outer);
+
+        std::cout << "\n  " << BOLD << std::left << std::setw(28) << "round" << std::right
+                  << std::setw(16) << "us/flush" << RESET << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "no sink installed" << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(16) << untraced_us << "\n";
+        std::cout << "  " << std::left << std::setw(28) << "recording spans" << std::right
+                  << std::setw(16) << traced_us << "\n\n";
+
+        std::string trace_path = data_dir + "/kvs_59_trace.json";
+        if (sink->dump(trace_path)) {
+            printSuccess("Recorded " + std::to_string(sink->recorded() - before) + " spans; wrote " + trace_path);
+            printInfo("Open it in https://ui.perfetto.dev or chrome://tracing");
+        } else {
+            printError("Failed to write " + trace_path);
+        }
+    }
+
+    void replayRecording(const std::string& trace_path, bool timed) {
+        printHeader("Replaying " + trace_path);
+
+        auto trace = kvs_demo::OperationTrace::load(trace_path);
+        if (!trace) {
+            printError("Failed to read " + trace_path + " (not an operation recording?)");
+            return;
+        }
+        printInfo(std::to_string(trace->operations().size()) + " calls recorded on instance " +
+                  std::to_string(trace->instance()) + " over " +
+                  std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(trace->duration()).count()) +
+                  " ms; replaying into an emptied instance 60, " + (timed ? "at the recorded pace" : "back to back"));
+
+        auto kvs = openEmptyInstance(InstanceId(60));
+        if (!kvs) {
+            return;
+        }
+        auto pacing = timed ? kvs_demo::ReplayPacing::Recorded : kvs_demo::ReplayPacing::AsFastAsPossible;
+        printReplayStats(kvs_demo::replay(*trace, *kvs, pacing));
+    }
+
+    void printBuildStats() {
+        printHeader("Startup Cost per Instance");
+
+        // Read-only, and unlike a manifest never stale: scan() lists what is on disk now
+        kvs_demo::DirectoryManifest manifest(data_dir);
+        if (!manifest.scan()) {
+            printError("Failed to list instances in " + data_dir);
+            return;
+        }
+        auto instance_ids = manifest.instances();
+        if (instance_ids.empty()) {
+            printInfo("No instances found in " + data_dir + " (run the demo first)");
+            return;
+        }
+
+        printInfo("'build' is KvsBuilder::build() in microseconds, all phases together: the library");
+        printInfo("has no hooks to time open, read, checksum, parse and map construction apart.");
+        std::cout << "\n  " << BOLD << std::left << std::setw(10) << "instance" << std::right << std::setw(12)
+                  << "build" << std::setw(12) << "file bytes" << std::setw(10) << "allocs" << std::setw(14)
+                  << "alloc bytes" << RESET << "\n";
+
+        for (size_t id : instance_ids) {
+            kvs_demo::BuildStats stats;
+            auto result = kvs_demo::buildWithStats(InstanceId(id), data_dir, false, true, stats);
+            std::cout << "  " << std::left << std::setw(10) << id << std::right << std::setw(12)
+                      << stats.build.count() << std::setw(12) << stats.file_bytes << std::setw(10)
+                      << stats.allocations << std::setw(14) << stats.allocated_bytes;
+            if (!result) {
+                std::cout << RED << "  build failed" << RESET;
+            }
+            std::cout << "\n";
+        }
+    }
+
+    void runCrashRecoveryHarness() {
+        printHeader("Crash Recovery Harness");
+
+        printInfo("A child process sets and flushes a counter in a loop and reports every");
+        printInfo("acknowledged flush; it is then killed with SIGKILL and the store reopened.");
+        printInfo("SIGKILL keeps the page cache, so this validates the on-disk layout after a");
+        printInfo("process crash; power-cut behaviour needs a VM or dm-flakey on top of this.");
+        std::cout << "\n  " << BOLD << std::left << std::setw(12) << "policy"
+                  << std::right << std::setw(12) << "acked" << std::setw(12) << "recovered"
+                  << std::setw(10) << "result" << RESET << "\n";
+
+        size_t instance = 20;
+        for (DurabilityPolicy policy : ALL_DURABILITY_POLICIES) {
+            InstanceId instance_id(instance++);
+
+            int ack_pipe[2];
+            if (pipe(ack_pipe) != 0) {
+                printError("Failed to create acknowledgement pipe");
+                return;
+            }
+
+            pid_t child = fork();
+            if (child < 0) {
+                printError("Failed to fork crash-test child");
+                close(ack_pipe[0]);
+                close(ack_pipe[1]);
+                return;
+            }
+
+            if (child == 0) {
+                close(ack_pipe[0]);
+                auto builder_result = KvsBuilder(instance_id)
+                    .need_defaults_flag(false)
+                    .need_kvs_flag(false)
+                    .dir(std::string(data_dir))
+                    .build();
+                if (!builder_result) {
+                    _exit(1);
+                }
+                Kvs kvs = std::move(builder_result.value());
+                DurableFlusher flusher(data_dir, instance_id, policy, std::chrono::milliseconds(20));
+                for (int64_t i = 1;; ++i) {
+                    kvs.set_value("counter", KvsValue(i));
+                    if (!flusher.flush(kvs)) {
+                        _exit(1);
+                    }
+                    if (write(ack_pipe[1], &i, sizeof(i)) != static_cast<ssize_t>(sizeof(i))) {
+                        _exit(1);
+                    }
+                }
+            }
+
+            close(ack_pipe[1]);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            kill(child, SIGKILL);
+            waitpid(child, nullptr, 0);
+
+            int64_t acked = 0;
+            int64_t value = 0;
+            while (read(ack_pipe[0], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+                acked = value;
+            }
+            close(ack_pipe[0]);
+
+            int64_t recovered = -1;
+            auto builder_result = KvsBuilder(instance_id)
+                .need_defaults_flag(false)
+                .need_kvs_flag(true)
+                .dir(std::string(data_dir))
+                .build();
+            if (builder_result) {
+                auto counter_result = builder_result.value().get_value("counter");
+                if (counter_result && counter_result.value().getType() == KvsValue::Type::i64) {
+                    recovered = std::get<int64_t>(counter_result.value().getValue());
+                }
+            }
+
+            bool passed = recovered >= acked && acked > 0;
+            std::cout << "  " << std::left << std::setw(12) << kvs_demo::to_string(policy) << std::right
+                      << std::setw(12) << acked << std::setw(12) << recovered
+                      << (passed ? GREEN : RED) << std::setw(10) << (passed ? "ok" : "LOST") << RESET << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    void run() {
+        std::cout << BOLD << GREEN << "\n🚀 KVS C++ Library Demonstration Program" << RESET << "\n";
+        std::cout << BLUE << "Data directory: " << data_dir << RESET << "\n\n";
+
+        printInfo("Press Enter to continue between demonstrations...");
+
+        demonstrateBasicOperations();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateArraysAndObjects();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateBlobStorage();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateBytes();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateTimeSeries();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateKeyIndex();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateSecondaryIndexes();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstratePredicateScan();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateExpiringKeys();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateSubscriptions();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateMemoryBudget();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateMetrics();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateMemoryStats();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateRecordReplay();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateSnapshots();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateDefaults();
+        std::cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+        std::cin.get();
+
+        demonstrateReset();
+
+        printHeader("Demonstration Complete");
+        printSuccess("All KVS features have been demonstrated!");
+        printInfo("Check the files in '" + data_dir + "' to see the persisted data");
+
+        std::cout << BOLD << GREEN << "\n✨ Thank you for exploring the KVS C++ library!" << RESET << "\n\n";
+    }
+};
+
+// The program-wide operator new, replaced here rather than in a library
+// source so that only this executable gets it: it reports every allocation
+// to kvs_demo::countAllocation() for --build-stats.
+// operator new[] and the array deletes forward to these. The deletes are
+// kept out of line: inlined into this file's delete expressions, GCC would
+// pair its built-in new with free() and warn about a mismatch.
+void* operator new(std::size_t size) {
+    kvs_demo::countAllocation(size);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Replaced too, so that a sanitizer runtime's own version is never paired
+// with the free() below
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    kvs_demo::countAllocation(size);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    std::string data_dir = "./kvs_demo_data";
+    std::string mode;
+    bool trace = false;
+    bool timed = false;
+    std::string replay_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bench" || arg == "--crash-test" || arg == "--bytes" || arg == "--build-stats") {
+            mode = arg;
+        } else if (arg == "--trace") {
+            trace = true;
+        } else if (arg == "--replay") {
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " [data_dir] [--bench | --crash-test | --bytes | --build-stats"
+                          << " | --replay <file> [--timed]] [--trace]" << std::endl;
+                return 1;
+            }
+            mode = arg;
+            replay_path = argv[++i];
+        } else if (arg == "--timed") {
+            timed = true;
+        } else {
+            data_dir = arg;
+        }
+    }
 
     // Create data directory if it doesn't exist
     // Using system() for simplicity - in production code you'd use proper directory creation
     std::string mkdir_cmd = "mkdir -p " + data_dir;
     system(mkdir_cmd.c_str());
 
+    // Spans of the whole run, written as Chrome trace-event JSON on exit
+    std::unique_ptr<kvs_demo::TraceSink> trace_sink;
+    if (trace) {
+        trace_sink = std::make_unique<kvs_demo::TraceSink>();
+        kvs_demo::TraceSink::install(trace_sink.get());
+    }
+
     try {
         KvsDemo demo(data_dir);
-        demo.run();
+        if (mode == "--bench") {
+            demo.benchmarkDurability();
+            demo.benchmarkStoreFormat();
+            demo.benchmarkRecovery();
+            demo.benchmarkPersistentObject();
+            demo.benchmarkDeduplication();
+            demo.benchmarkWarmStart();
+            demo.benchmarkParallelStartup();
+            demo.benchmarkManifest();
+            demo.benchmarkProbeOverhead();
+            demo.benchmarkTracing();
+        } else if (mode == "--crash-test") {
+            demo.runCrashRecoveryHarness();
+        } else if (mode == "--bytes") {
+            demo.demonstrateBytes();
+        } else if (mode == "--build-stats") {
+            demo.printBuildStats();
+        } else if (mode == "--replay") {
+            demo.replayRecording(replay_path, timed);
+        } else {
+            demo.run();
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
 
+    if (trace_sink) {
+        kvs_demo::TraceSink::install(nullptr);
+        std::string trace_path = data_dir + "/kvs_trace.json";
+        if (trace_sink->dump(trace_path)) {
+            std::cout << "Trace of " << trace_sink->recorded() << " spans written to " << trace_path << std::endl;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
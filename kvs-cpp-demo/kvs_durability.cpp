@@ -0,0 +1,134 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_durability.cpp
+ * @brief fsync/fdatasync handling for the demo durability policies
+ */
+
+#include "kvs_durability.hpp"
+#include "kvs_store_file.hpp"
+#include "kvs_trace.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace kvs_demo {
+
+namespace {
+
+bool syncPath(const std::string& path, bool data_only, bool directory) {
+    int fd = ::open(path.c_str(), (directory ? O_RDONLY | O_DIRECTORY : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    int rc = data_only ? ::fdatasync(fd) : ::fsync(fd);
+    ::close(fd);
+    return rc == 0;
+}
+
+} // namespace
+
+const char* to_string(DurabilityPolicy policy) {
+    switch (policy) {
+        case DurabilityPolicy::Full:
+            return "full";
+        case DurabilityPolicy::DataOnly:
+            return "data-only";
+        case DurabilityPolicy::Deferred:
+            return "deferred";
+        case DurabilityPolicy::None:
+            return "none";
+    }
+    return "unknown";
+}
+
+DurableFlusher::DurableFlusher(const std::string& dir, InstanceId instance_id, DurabilityPolicy policy,
+                               std::chrono::milliseconds deferred_period)
+    : instance(instance_id.id),
+      data_dir(dir),
+      json_path(storePath(dir, instance_id.id, "0.json")),
+      hash_path(storePath(dir, instance_id.id, "0.hash")),
+      mode(policy),
+      deferred_period(deferred_period) {
+    if (mode == DurabilityPolicy::Deferred) {
+        syncer = std::thread(&DurableFlusher::deferredLoop, this);
+    }
+}
+
+DurableFlusher::~DurableFlusher() {
+    if (syncer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        syncer.join();
+    }
+    // Never drop a pending deferred sync on the floor
+    sync_now();
+}
+
+bool DurableFlusher::flush(Kvs& kvs) {
+    TraceSpan span("flush", "kvs", static_cast<int64_t>(instance));
+    {
+        // Serialization, hashing, writing and rotation all happen inside the library
+        TraceSpan library_span("Kvs::flush", "kvs", static_cast<int64_t>(instance));
+        if (!kvs.flush()) {
+            return false;
+        }
+    }
+
+    switch (mode) {
+        case DurabilityPolicy::Full:
+            return syncFiles(false);
+        case DurabilityPolicy::DataOnly:
+            return syncFiles(true);
+        case DurabilityPolicy::Deferred:
+            dirty.store(true, std::memory_order_release);
+            return true;
+        case DurabilityPolicy::None:
+            return true;
+    }
+    return true;
+}
+
+bool DurableFlusher::sync_now() {
+    if (!dirty.exchange(false, std::memory_order_acq_rel)) {
+        return true;
+    }
+    return syncFiles(true);
+}
+
+bool DurableFlusher::syncFiles(bool data_only) {
+    TraceSpan span("fsync", "io", static_cast<int64_t>(instance));
+    // The hash is checked against the JSON on load, so both must be on disk
+    // before the rename of the previous generation is made durable.
+    bool ok = syncPath(json_path, data_only, false);
+    ok = syncPath(hash_path, data_only, false) && ok;
+    if (!data_only || mode == DurabilityPolicy::Deferred) {
+        ok = syncPath(data_dir, false, true) && ok;
+    }
+    return ok;
+}
+
+void DurableFlusher::deferredLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wakeup.wait_for(lock, deferred_period, [this] { return stopping; });
+        lock.unlock();
+        sync_now();
+        lock.lock();
+    }
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,91 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_durability.hpp
+ * @brief Per-instance durability policy applied on top of Kvs::flush()
+ *
+ * Kvs::flush() writes kvs_<id>_0.json/.hash and rotates the snapshots, but
+ * leaves it to the page cache to decide when the data reaches the disk.
+ * DurableFlusher wraps flush() and syncs the freshly written files according
+ * to the selected policy:
+ * - Full:     fsync() of the store files and of the directory (renames)
+ * - DataOnly: fdatasync() of the store files, directory left alone
+ * - Deferred: fdatasync() + directory fsync() from a background thread,
+ *             at most once per period
+ * - None:     no explicit sync, best effort only
+ */
+
+#ifndef KVS_DEMO_DURABILITY_HPP
+#define KVS_DEMO_DURABILITY_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+enum class DurabilityPolicy {
+    Full,
+    DataOnly,
+    Deferred,
+    None,
+};
+
+const char* to_string(DurabilityPolicy policy);
+
+class DurableFlusher {
+public:
+    DurableFlusher(const std::string& dir, InstanceId instance_id, DurabilityPolicy policy,
+                   std::chrono::milliseconds deferred_period = std::chrono::milliseconds(1000));
+    ~DurableFlusher();
+
+    DurableFlusher(const DurableFlusher&) = delete;
+    DurableFlusher& operator=(const DurableFlusher&) = delete;
+
+    /// Flush the instance and make it durable as far as the policy requires.
+    /// Returns false if either the flush or the sync failed.
+    bool flush(Kvs& kvs);
+
+    /// Force any deferred sync to happen now.
+    bool sync_now();
+
+    DurabilityPolicy policy() const { return mode; }
+
+private:
+    bool syncFiles(bool data_only);
+    void deferredLoop();
+
+    size_t instance;
+    std::string data_dir;
+    std::string json_path;
+    std::string hash_path;
+    DurabilityPolicy mode;
+    std::chrono::milliseconds deferred_period;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> dirty{false};
+    bool stopping = false;
+    std::thread syncer;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_DURABILITY_HPP
@@ -0,0 +1,84 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_field_index.cpp
+ * @brief Incrementally maintained field-value-to-keys index
+ */
+
+#include "kvs_field_index.hpp"
+#include "kvs_path.hpp"
+#include "kvs_value_codec.hpp"
+
+namespace kvs_demo {
+
+namespace {
+
+// The shared encoding sorts Object members, so equal values encode alike.
+// Values too deep to encode are not indexed.
+std::optional<std::string> indexKey(const KvsValue& value) {
+    std::string encoded;
+    if (!encodeValueShared(value, encoded)) {
+        return std::nullopt;
+    }
+    return encoded;
+}
+
+} // namespace
+
+FieldIndex::FieldIndex(std::string_view field_path) : segments(parsePath(field_path)) {}
+
+std::vector<std::string> FieldIndex::query(const KvsValue& value) const {
+    auto encoded = indexKey(value);
+    auto found = encoded ? postings.find(*encoded) : postings.end();
+    if (found == postings.end()) {
+        return {};
+    }
+    return {found->second.begin(), found->second.end()};
+}
+
+void FieldIndex::on_set(std::string_view key, const KvsValue& value) {
+    on_remove(key);
+    const KvsValue* field = findPath(value, segments, 0);
+    if (field == nullptr) {
+        return;
+    }
+    auto encoded = indexKey(*field);
+    if (!encoded) {
+        return;
+    }
+    postings[*encoded].emplace(key);
+    indexed.emplace(std::string(key), std::move(*encoded));
+}
+
+void FieldIndex::on_remove(std::string_view key) {
+    auto found = indexed.find(std::string(key));
+    if (found == indexed.end()) {
+        return;
+    }
+    auto posting = postings.find(found->second);
+    if (posting != postings.end()) {
+        posting->second.erase(found->first);
+        if (posting->second.empty()) {
+            postings.erase(posting);
+        }
+    }
+    indexed.erase(found);
+}
+
+void FieldIndex::on_reset() {
+    postings.clear();
+    indexed.clear();
+}
+
+} // namespace kvs_demo
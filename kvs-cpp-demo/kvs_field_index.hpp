@@ -0,0 +1,62 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_field_index.hpp
+ * @brief Secondary indexes on fields of Object values
+ *
+ * A FieldIndex maps the value found at a field path inside each stored value
+ * (e.g. "location" or "settings/sample_rate", in kvs_path.hpp syntax but
+ * without the key) to the keys holding it. It is a KvsListener, so a
+ * TrackedKvs keeps it up to date on every write and rebuilds it from the
+ * store when it is registered, e.g. right after loading.
+ *
+ * Field values match by type and content: an i32 1 does not match a u64 1.
+ */
+
+#ifndef KVS_DEMO_FIELD_INDEX_HPP
+#define KVS_DEMO_FIELD_INDEX_HPP
+
+#include "kvs_tracked.hpp"
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kvs_demo {
+
+class FieldIndex : public KvsListener {
+public:
+    explicit FieldIndex(std::string_view field_path);
+
+    /// Keys whose value has field equal to value, in sorted order.
+    std::vector<std::string> query(const KvsValue& value) const;
+
+    /// Number of keys whose value has the field.
+    size_t size() const { return indexed.size(); }
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_reset() override;
+
+private:
+    std::vector<std::string> segments;
+    // Encoded field value -> keys, and the reverse for updates
+    std::unordered_map<std::string, std::set<std::string>> postings;
+    std::unordered_map<std::string, std::string> indexed;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_FIELD_INDEX_HPP
@@ -0,0 +1,181 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_intern.cpp
+ * @brief Interning table for KvsValue subtrees
+ */
+
+#include "kvs_intern.hpp"
+#include "kvs_value_codec.hpp"
+#include <string>
+
+namespace kvs_demo {
+
+namespace {
+
+bool isContainer(KvsValue::Type type) {
+    return type == KvsValue::Type::Array || type == KvsValue::Type::Object;
+}
+
+bool isInterned(KvsValue::Type type) {
+    return type == KvsValue::Type::String || isContainer(type);
+}
+
+uint64_t hashBytes(const std::string& bytes) {
+    return fnv1a64(bytes.data(), bytes.size());
+}
+
+} // namespace
+
+std::shared_ptr<KvsValue> ValueInterner::intern(const KvsValue& value) {
+    if (!isInterned(value.getType())) {
+        return std::make_shared<KvsValue>(value);
+    }
+
+    ++counters.lookups;
+    KvsValue canonical = withCanonicalChildren(value);
+    uint64_t hash = hashOf(canonical);
+    auto range = nodes.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (sameNode(*it->second, canonical)) {
+            ++counters.hits;
+            return it->second;
+        }
+    }
+
+    auto node = std::make_shared<KvsValue>(std::move(canonical));
+    hashes.emplace(node.get(), hash);
+    nodes.emplace(hash, node);
+    return node;
+}
+
+KvsValue ValueInterner::internChildren(const KvsValue& value) {
+    return isContainer(value.getType()) ? withCanonicalChildren(value) : value;
+}
+
+size_t ValueInterner::collectGarbage() {
+    size_t removed = 0;
+    // Releasing a parent can release its children, so repeat until stable
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto it = nodes.begin(); it != nodes.end();) {
+            if (it->second.use_count() == 1) {
+                hashes.erase(it->second.get());
+                it = nodes.erase(it);
+                ++removed;
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return removed;
+}
+
+KvsValue ValueInterner::withCanonicalChildren(const KvsValue& value) {
+    if (value.getType() == KvsValue::Type::Array) {
+        KvsValue::Array array;
+        const auto& source = std::get<KvsValue::Array>(value.getValue());
+        array.reserve(source.size());
+        for (const auto& element : source) {
+            array.push_back(intern(element ? *element : KvsValue(nullptr)));
+        }
+        return KvsValue(array);
+    }
+    if (value.getType() == KvsValue::Type::Object) {
+        KvsValue::Object object;
+        for (const auto& [key, element] : std::get<KvsValue::Object>(value.getValue())) {
+            object.emplace(key, intern(element ? *element : KvsValue(nullptr)));
+        }
+        return KvsValue(object);
+    }
+    return value;
+}
+
+uint64_t ValueInterner::hashOf(const KvsValue& value) const {
+    std::string material(1, static_cast<char>(value.getType()));
+    if (value.getType() == KvsValue::Type::Array) {
+        for (const auto& element : std::get<KvsValue::Array>(value.getValue())) {
+            uint64_t hash = childHash(element);
+            material.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        }
+    } else if (value.getType() == KvsValue::Type::Object) {
+        // Summed per entry, so the unordered iteration order does not matter
+        uint64_t sum = 0;
+        for (const auto& [key, element] : std::get<KvsValue::Object>(value.getValue())) {
+            uint64_t hash = childHash(element);
+            sum += hashBytes(key + std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)));
+        }
+        material.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+    } else {
+        encodeValue(value, material);
+    }
+    return hashBytes(material);
+}
+
+uint64_t ValueInterner::childHash(const std::shared_ptr<KvsValue>& child) const {
+    if (!child) {
+        return 0;
+    }
+    auto found = hashes.find(child.get());
+    if (found != hashes.end()) {
+        return found->second;
+    }
+    std::string material;
+    encodeValue(*child, material);
+    return hashBytes(material);
+}
+
+bool ValueInterner::sameNode(const KvsValue& a, const KvsValue& b) {
+    if (a.getType() != b.getType()) {
+        return false;
+    }
+    // Interned children are equal exactly when they are the same node
+    auto sameChild = [](const std::shared_ptr<KvsValue>& x, const std::shared_ptr<KvsValue>& y) {
+        if (x == y) {
+            return true;
+        }
+        return x && y && !isInterned(x->getType()) && valuesEqual(*x, *y);
+    };
+    if (a.getType() == KvsValue::Type::Array) {
+        const auto& x = std::get<KvsValue::Array>(a.getValue());
+        const auto& y = std::get<KvsValue::Array>(b.getValue());
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < x.size(); ++i) {
+            if (!sameChild(x[i], y[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (a.getType() == KvsValue::Type::Object) {
+        const auto& x = std::get<KvsValue::Object>(a.getValue());
+        const auto& y = std::get<KvsValue::Object>(b.getValue());
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (const auto& [key, element] : x) {
+            auto other = y.find(key);
+            if (other == y.end() || !sameChild(element, other->second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return valuesEqual(a, b);
+}
+
+} // namespace kvs_demo
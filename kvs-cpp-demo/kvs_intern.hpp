@@ -0,0 +1,74 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_intern.hpp
+ * @brief Hash-consing of KvsValue subtrees
+ *
+ * A ValueInterner keeps one canonical node per distinct String, Array and
+ * Object. Interning a value interns its children first, so two equal
+ * subtrees end up as the same shared_ptr no matter which key or instance
+ * they came from. Since children are already canonical, a node is compared
+ * by its own payload and the addresses of its children.
+ *
+ * Interned nodes are shared: treat them as immutable and update them by
+ * copying, as set_path() does.
+ */
+
+#ifndef KVS_DEMO_INTERN_HPP
+#define KVS_DEMO_INTERN_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+class ValueInterner {
+public:
+    struct Stats {
+        size_t lookups = 0;
+        size_t hits = 0;
+    };
+
+    /// Canonical node for value; scalars are not interned and just boxed.
+    std::shared_ptr<KvsValue> intern(const KvsValue& value);
+
+    /// Copy of value whose children are canonical, for passing to set_value().
+    KvsValue internChildren(const KvsValue& value);
+
+    /// Drop canonical nodes that nothing outside the interner still uses.
+    size_t collectGarbage();
+
+    size_t size() const { return nodes.size(); }
+    const Stats& stats() const { return counters; }
+
+private:
+    KvsValue withCanonicalChildren(const KvsValue& value);
+    uint64_t hashOf(const KvsValue& value) const;
+    uint64_t childHash(const std::shared_ptr<KvsValue>& child) const;
+    static bool sameNode(const KvsValue& a, const KvsValue& b);
+
+    std::unordered_multimap<uint64_t, std::shared_ptr<KvsValue>> nodes;
+    // Hash of every canonical node, by address
+    std::unordered_map<const KvsValue*, uint64_t> hashes;
+    Stats counters;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_INTERN_HPP
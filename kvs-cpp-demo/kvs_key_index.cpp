@@ -0,0 +1,65 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_key_index.cpp
+ * @brief Ordered key index maintained from change notifications
+ */
+
+#include "kvs_key_index.hpp"
+
+namespace kvs_demo {
+
+OrderedKeyIndex::Range OrderedKeyIndex::scan_prefix(std::string_view prefix) const {
+    auto first = keys.lower_bound(prefix);
+
+    // The first string past every key with this prefix: drop trailing 0xff
+    // bytes and increment the last remaining one
+    std::string upper(prefix);
+    while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xff) {
+        upper.pop_back();
+    }
+    if (upper.empty()) {
+        return Range{first, keys.end()};
+    }
+    upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+    return Range{first, keys.lower_bound(upper)};
+}
+
+OrderedKeyIndex::Range OrderedKeyIndex::scan_range(std::string_view from, std::string_view to) const {
+    auto first = keys.lower_bound(from);
+    if (to.empty()) {
+        return Range{first, keys.end()};
+    }
+    auto last = keys.lower_bound(to);
+    // An inverted range is empty rather than undefined
+    if (to <= from) {
+        last = first;
+    }
+    return Range{first, last};
+}
+
+void OrderedKeyIndex::on_set(std::string_view key, const KvsValue&) {
+    if (keys.find(key) == keys.end()) {
+        keys.emplace(key);
+    }
+}
+
+void OrderedKeyIndex::on_remove(std::string_view key) {
+    auto it = keys.find(key);
+    if (it != keys.end()) {
+        keys.erase(it);
+    }
+}
+
+} // namespace kvs_demo
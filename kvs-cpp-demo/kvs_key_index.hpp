@@ -0,0 +1,67 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_key_index.hpp
+ * @brief Sorted index of keys with prefix and range scans
+ *
+ * get_all_keys() returns keys in no particular order, so a namespace query
+ * such as "everything under sensor/room_a/" has to look at every key. An
+ * OrderedKeyIndex listens to a TrackedKvs and keeps the keys in a balanced
+ * search tree ordered bytewise, which makes a prefix or range scan
+ * O(log n + k) for k results.
+ */
+
+#ifndef KVS_DEMO_KEY_INDEX_HPP
+#define KVS_DEMO_KEY_INDEX_HPP
+
+#include "kvs_tracked.hpp"
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace kvs_demo {
+
+class OrderedKeyIndex : public KvsListener {
+public:
+    using const_iterator = std::set<std::string, std::less<>>::const_iterator;
+
+    /// Iterator pair usable in a range-based for loop.
+    struct Range {
+        const_iterator first;
+        const_iterator last;
+
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    /// Keys starting with prefix, in order.
+    Range scan_prefix(std::string_view prefix) const;
+
+    /// Keys in [from, to), in order; an empty to means no upper bound.
+    Range scan_range(std::string_view from, std::string_view to) const;
+
+    size_t size() const { return keys.size(); }
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_reset() override { keys.clear(); }
+
+private:
+    std::set<std::string, std::less<>> keys;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_KEY_INDEX_HPP
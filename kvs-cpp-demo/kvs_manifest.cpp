@@ -0,0 +1,255 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_manifest.cpp
+ * @brief Reading, rebuilding and updating the directory manifest
+ */
+
+#include "kvs_manifest.hpp"
+#include "kvs_store_file.hpp"
+#include "internal/kvs_helper.hpp"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <dirent.h>
+
+namespace kvs_demo {
+
+namespace {
+
+const char MANIFEST_MAGIC[4] = {'K', 'V', 'S', 'M'};
+constexpr uint8_t MANIFEST_VERSION = 1;
+constexpr size_t MANIFEST_HEADER_SIZE = 16;
+
+void putBigEndian(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i-- > 0;) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+uint64_t getBigEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+/// Parse "kvs_<id>_<generation>.json"; nothing for any other name, or for
+/// an id too large for the manifest.
+std::optional<std::pair<size_t, size_t>> parseStoreName(const std::string& name) {
+    const std::string prefix = "kvs_";
+    const std::string suffix = ".json";
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return std::nullopt;
+    }
+    std::string middle = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    size_t separator = middle.find('_');
+    if (separator == 0 || separator == std::string::npos || separator + 1 == middle.size() ||
+        middle.find_first_not_of("0123456789_") != std::string::npos ||
+        middle.find('_', separator + 1) != std::string::npos) {
+        return std::nullopt;
+    }
+    const char* digits = middle.data();
+    uint64_t instance_id = 0;
+    uint64_t generation = 0;
+    auto parsed_id = std::from_chars(digits, digits + separator, instance_id);
+    auto parsed_generation = std::from_chars(digits + separator + 1, digits + middle.size(), generation);
+    if (parsed_id.ec != std::errc() || instance_id > UINT32_MAX || parsed_generation.ec != std::errc()) {
+        return std::nullopt;
+    }
+    return std::make_pair(static_cast<size_t>(instance_id), static_cast<size_t>(generation));
+}
+
+} // namespace
+
+DirectoryManifest::DirectoryManifest(const std::string& dir)
+    : data_dir(dir), manifest_path(dir + "/kvs_manifest.bin") {}
+
+bool DirectoryManifest::load() {
+    std::ifstream file(manifest_path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < MANIFEST_HEADER_SIZE) {
+        return false;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t body_size = getBigEndian(bytes + 12, 4);
+    if (std::memcmp(bytes, MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) != 0 || bytes[4] != MANIFEST_VERSION ||
+        body_size != data.size() - MANIFEST_HEADER_SIZE ||
+        getBigEndian(bytes + 8, 4) != calculate_hash_adler32(data.substr(MANIFEST_HEADER_SIZE))) {
+        return false;
+    }
+
+    std::map<size_t, std::vector<ManifestGeneration>> parsed;
+    const uint8_t* cursor = bytes + MANIFEST_HEADER_SIZE;
+    const uint8_t* end = cursor + body_size;
+    while (cursor != end) {
+        if (end - cursor < 8) {
+            return false;
+        }
+        size_t instance_id = getBigEndian(cursor, 4);
+        size_t count = getBigEndian(cursor + 4, 4);
+        cursor += 8;
+        if (static_cast<size_t>(end - cursor) / 12 < count) {
+            return false;
+        }
+        auto& generations = parsed[instance_id];
+        for (size_t i = 0; i < count; ++i, cursor += 12) {
+            generations.push_back({getBigEndian(cursor, 8), static_cast<uint32_t>(getBigEndian(cursor + 8, 4))});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries = std::move(parsed);
+    loaded = true;
+    return true;
+}
+
+bool DirectoryManifest::rebuild() {
+    if (!scan()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return save();
+}
+
+bool DirectoryManifest::scan() {
+    DIR* dir = ::opendir(data_dir.c_str());
+    if (!dir) {
+        return false;
+    }
+    std::map<size_t, std::map<size_t, ManifestGeneration>> scanned;
+    while (struct dirent* entry = ::readdir(dir)) {
+        auto parsed = parseStoreName(entry->d_name);
+        auto generation = parsed ? probe(parsed->first, parsed->second) : std::nullopt;
+        if (generation) {
+            scanned[parsed->first][parsed->second] = *generation;
+        }
+    }
+    ::closedir(dir);
+
+    std::map<size_t, std::vector<ManifestGeneration>> found;
+    for (const auto& [instance_id, by_number] : scanned) {
+        appendGenerations(found[instance_id], by_number.size(), [&by_number = by_number](size_t generation) {
+            auto it = by_number.find(generation);
+            return it == by_number.end() ? std::nullopt : std::optional<ManifestGeneration>(it->second);
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries = std::move(found);
+    loaded = true;
+    return true;
+}
+
+bool DirectoryManifest::flush(Kvs& kvs, InstanceId instance_id) {
+    if (instance_id.id > UINT32_MAX || !kvs.flush()) {
+        return false;
+    }
+    // Otherwise save() would drop every instance already in the file
+    bool known;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        known = loaded;
+    }
+    if (!known) {
+        load();
+    }
+    auto current = probe(instance_id.id, 0);
+    if (!current) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded = true;
+    auto [entry, inserted] = entries.try_emplace(instance_id.id);
+    auto& generations = entry->second;
+    if (inserted) {
+        // No history to shift down, so take the generations the flush left behind
+        generations.push_back(*current);
+        appendGenerations(generations, kvs.snapshot_max_count(),
+                          [&](size_t generation) { return probe(instance_id.id, generation); });
+    } else {
+        // The flush rotated N to N+1, dropping whatever falls past the snapshot limit
+        rotateGenerations(generations, *current, kvs.snapshot_max_count());
+    }
+    return save();
+}
+
+std::optional<size_t> DirectoryManifest::snapshot_count(InstanceId instance_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(instance_id.id);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    // Generation 0 is the current store, not a snapshot
+    return it->second.empty() ? 0 : it->second.size() - 1;
+}
+
+std::optional<std::vector<ManifestGeneration>> DirectoryManifest::generations(InstanceId instance_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(instance_id.id);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<size_t> DirectoryManifest::instances() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<size_t> ids;
+    ids.reserve(entries.size());
+    for (const auto& [instance_id, generations] : entries) {
+        ids.push_back(instance_id);
+    }
+    return ids;
+}
+
+std::optional<ManifestGeneration> DirectoryManifest::probe(size_t instance_id, size_t generation) const {
+    auto file = probeGeneration(data_dir, instance_id, generation);
+    if (!file) {
+        return std::nullopt;
+    }
+    return ManifestGeneration{file->json_size, file->checksum};
+}
+
+bool DirectoryManifest::save() const {
+    std::string body;
+    for (const auto& [instance_id, generations] : entries) {
+        putBigEndian(body, instance_id, 4);
+        putBigEndian(body, generations.size(), 4);
+        for (const auto& generation : generations) {
+            putBigEndian(body, generation.json_size, 8);
+            putBigEndian(body, generation.checksum, 4);
+        }
+    }
+
+    std::string data(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+    putBigEndian(data, MANIFEST_VERSION, 1);
+    putBigEndian(data, 0, 3);
+    putBigEndian(data, calculate_hash_adler32(body), 4);
+    putBigEndian(data, body.size(), 4);
+    data.append(body);
+
+    SyscallCounter counter;
+    return writeFileAtomically(manifest_path, data, counter);
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,100 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_manifest.hpp
+ * @brief Per-directory manifest of instances and snapshot generations
+ *
+ * Finding out which instances live in a directory and how many snapshots
+ * each one has means probing kvs_<id>_N.json/.hash for every N. The
+ * manifest, kvs_manifest.bin, records the same facts in one small file:
+ *
+ *   offset  size  field (big-endian, as in kvs_store_file.hpp)
+ *   0       4     magic "KVSM"
+ *   4       1     format version (1)
+ *   5       3     reserved, zero
+ *   8       4     Adler-32 of the body
+ *   12      4     body length in bytes
+ *   16      n     per instance: u32 id, u32 generation count, then per
+ *                 generation (0 = current) u64 JSON size, u32 Adler-32
+ *
+ * DirectoryManifest::flush() flushes an instance and rewrites the manifest
+ * atomically. Since a flush rotates the generations, only generation 0 is
+ * probed; the older ones shift down from the manifest. An instance the
+ * manifest does not know yet has all its generations probed instead.
+ * Flushes that bypass the manifest leave it stale; rebuild() rescans the
+ * directory once. Instance ids above 2^32 - 1 do not fit and are skipped.
+ */
+
+#ifndef KVS_DEMO_MANIFEST_HPP
+#define KVS_DEMO_MANIFEST_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+struct ManifestGeneration {
+    uint64_t json_size;
+    uint32_t checksum;
+};
+
+class DirectoryManifest {
+public:
+    explicit DirectoryManifest(const std::string& dir);
+
+    /// Read the manifest; false if it is missing or corrupted.
+    bool load();
+
+    /// Scan the directory once and take what is found, without writing.
+    bool scan();
+
+    /// scan(), then rewrite the manifest from what was found.
+    bool rebuild();
+
+    /// Flush the instance and record its new generations in the manifest,
+    /// reading the manifest first if neither load() nor scan() ran yet.
+    bool flush(Kvs& kvs, InstanceId instance_id);
+
+    /// Same answer as Kvs::snapshot_count(), without touching the instance
+    /// files; nothing if the instance is not in the manifest.
+    std::optional<size_t> snapshot_count(InstanceId instance_id) const;
+
+    /// Generations of an instance, current first.
+    std::optional<std::vector<ManifestGeneration>> generations(InstanceId instance_id) const;
+
+    std::vector<size_t> instances() const;
+
+private:
+    std::optional<ManifestGeneration> probe(size_t instance_id, size_t generation) const;
+    bool save() const;
+
+    std::string data_dir;
+    std::string manifest_path;
+
+    mutable std::mutex mutex;
+    std::map<size_t, std::vector<ManifestGeneration>> entries;
+    bool loaded = false;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_MANIFEST_HPP
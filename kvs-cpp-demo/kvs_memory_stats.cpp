@@ -0,0 +1,222 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_memory_stats.cpp
+ * @brief Sizing values against the libstdc++ and glibc layouts
+ */
+
+#include "kvs_memory_stats.hpp"
+#include <memory>
+#include <utility>
+
+namespace kvs_demo {
+
+namespace {
+
+// Longest string kept in the std::string object itself
+constexpr size_t sso_capacity = 15;
+
+// unordered_map nodes hold the next pointer, the element and the cached hash
+template <typename Element>
+constexpr size_t hash_node_size = sizeof(void*) + sizeof(Element) + sizeof(size_t);
+
+using StoreElement = std::pair<const std::string, KvsValue>;
+using ObjectElement = std::pair<const std::string, std::shared_ptr<KvsValue>>;
+
+// make_shared puts the use/weak counts and the vtable pointer in front of the value
+constexpr size_t shared_header = 2 * sizeof(int) + sizeof(void*);
+
+/// glibc chunk size for an n-byte malloc(): 8-byte header, 16-byte
+/// alignment, 32 bytes at least.
+size_t chunkSize(size_t n) {
+    size_t chunk = (n + sizeof(size_t) + 15) & ~static_cast<size_t>(15);
+    return chunk < 32 ? 32 : chunk;
+}
+
+struct Sizer {
+    std::array<size_t, MemoryStats::type_count>& by_type;
+    size_t& keys;
+    size_t& slack;
+    size_t& allocations;
+
+    void allocate(size_t& owner, size_t bytes) {
+        owner += bytes;
+        slack += chunkSize(bytes) - bytes;
+        ++allocations;
+    }
+
+    void key(const std::string& name) {
+        if (name.size() > sso_capacity) {
+            allocate(keys, name.size() + 1);
+        }
+    }
+
+    /// Heap data of value, charged to its type; the KvsValue itself is
+    /// charged by whoever holds it.
+    void heap(const KvsValue& value) {
+        size_t& owner = by_type[static_cast<size_t>(value.getType())];
+        switch (value.getType()) {
+            case KvsValue::Type::String: {
+                const auto& string = std::get<std::string>(value.getValue());
+                if (string.size() > sso_capacity) {
+                    allocate(owner, string.size() + 1);
+                }
+                break;
+            }
+            case KvsValue::Type::Array: {
+                const auto& array = std::get<KvsValue::Array>(value.getValue());
+                if (!array.empty()) {
+                    allocate(owner, array.size() * sizeof(std::shared_ptr<KvsValue>));
+                }
+                for (const auto& element : array) {
+                    shared(owner, *element);
+                }
+                break;
+            }
+            case KvsValue::Type::Object: {
+                const auto& object = std::get<KvsValue::Object>(value.getValue());
+                // A single bucket lives inside the map object
+                if (object.bucket_count() > 1) {
+                    allocate(owner, object.bucket_count() * sizeof(void*));
+                }
+                for (const auto& [name, element] : object) {
+                    allocate(owner, hash_node_size<ObjectElement>);
+                    owner -= sizeof(std::string);
+                    keys += sizeof(std::string);
+                    key(name);
+                    shared(owner, *element);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /// An element made with make_shared: the header goes to the container,
+    /// the KvsValue to its own type.
+    void shared(size_t& container, const KvsValue& element) {
+        size_t bytes = shared_header + sizeof(KvsValue);
+        container += shared_header;
+        by_type[static_cast<size_t>(element.getType())] += sizeof(KvsValue);
+        slack += chunkSize(bytes) - bytes;
+        ++allocations;
+        heap(element);
+    }
+};
+
+} // namespace
+
+size_t MemoryStats::values() const {
+    size_t sum = 0;
+    for (size_t bytes : by_type) {
+        sum += bytes;
+    }
+    return sum;
+}
+
+const char* MemoryStats::typeName(KvsValue::Type type) {
+    switch (type) {
+        case KvsValue::Type::i32: return "i32";
+        case KvsValue::Type::u32: return "u32";
+        case KvsValue::Type::i64: return "i64";
+        case KvsValue::Type::u64: return "u64";
+        case KvsValue::Type::f64: return "f64";
+        case KvsValue::Type::Boolean: return "bool";
+        case KvsValue::Type::String: return "str";
+        case KvsValue::Type::Null: return "null";
+        case KvsValue::Type::Array: return "arr";
+        case KvsValue::Type::Object: return "obj";
+    }
+    return "?";
+}
+
+MemoryAccounting::MemoryAccounting(TrackedKvs& tracked) : tracked(tracked) {
+    tracked.add_listener(*this);
+}
+
+MemoryAccounting::~MemoryAccounting() {
+    tracked.remove_listener(*this);
+}
+
+MemoryStats MemoryAccounting::memory_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryStats stats = totals;
+    stats.entries = footprints.size();
+    // The bucket array depends on the whole map, so it is added here
+    size_t buckets = footprints.bucket_count();
+    if (buckets > 1) {
+        stats.index += buckets * sizeof(void*);
+        stats.slack += chunkSize(buckets * sizeof(void*)) - buckets * sizeof(void*);
+        ++stats.allocations;
+    }
+    return stats;
+}
+
+MemoryAccounting::Footprint MemoryAccounting::measure(std::string_view key, const KvsValue& value) {
+    Footprint footprint;
+    Sizer sizer{footprint.by_type, footprint.keys, footprint.slack, footprint.allocations};
+
+    // The store's map node: links and hash are index, the rest is key and value
+    size_t node = hash_node_size<StoreElement>;
+    sizer.allocate(footprint.index, node);
+    footprint.index -= sizeof(std::string) + sizeof(KvsValue);
+    footprint.keys += sizeof(std::string);
+    footprint.by_type[static_cast<size_t>(value.getType())] += sizeof(KvsValue);
+
+    sizer.key(std::string(key));
+    sizer.heap(value);
+    return footprint;
+}
+
+void MemoryAccounting::apply(const Footprint& footprint, bool add) {
+    auto update = [add](size_t& total, size_t bytes) { total = add ? total + bytes : total - bytes; };
+    for (size_t type = 0; type < MemoryStats::type_count; ++type) {
+        update(totals.by_type[type], footprint.by_type[type]);
+    }
+    update(totals.keys, footprint.keys);
+    update(totals.index, footprint.index);
+    update(totals.slack, footprint.slack);
+    update(totals.allocations, footprint.allocations);
+}
+
+void MemoryAccounting::on_set(std::string_view key, const KvsValue& value) {
+    Footprint footprint = measure(key, value);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [it, inserted] = footprints.try_emplace(std::string(key));
+    if (!inserted) {
+        apply(it->second, false);
+    }
+    it->second = footprint;
+    apply(footprint, true);
+}
+
+void MemoryAccounting::on_remove(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = footprints.find(std::string(key));
+    if (it == footprints.end()) {
+        return;
+    }
+    apply(it->second, false);
+    footprints.erase(it);
+}
+
+void MemoryAccounting::on_reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // clear() keeps the buckets, as the store's map does
+    footprints.clear();
+    totals = MemoryStats();
+}
+
+} // namespace kvs_demo
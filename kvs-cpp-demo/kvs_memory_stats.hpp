@@ -0,0 +1,105 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_memory_stats.hpp
+ * @brief Per-instance memory accounting by value type, kept incrementally
+ *
+ * The Kvs keeps its contents in an unordered_map<std::string, KvsValue>
+ * that is not visible from outside, so its memory use cannot be read off
+ * directly. MemoryAccounting follows a TrackedKvs instead: each on_set()
+ * sizes the one value being written, against the libstdc++ layouts of the
+ * map, KvsValue, std::string, vector and make_shared nodes and the glibc
+ * chunk rounding, and swaps its contribution for the previous one under
+ * that key. memory_stats() then only sums counters; the tree is never
+ * walked, so it can be polled while the store is in use.
+ *
+ * The results are a modelled estimate, not a measurement: they hold as far
+ * as the library's store and the allocator match those layouts, and
+ * allocations the library makes beyond the map (caches, buffers) are not
+ * seen. Writes that bypass the TrackedKvs are not seen either (call
+ * resync() on it), and array or object elements shared with other values
+ * are counted once per reference.
+ */
+
+#ifndef KVS_DEMO_MEMORY_STATS_HPP
+#define KVS_DEMO_MEMORY_STATS_HPP
+
+#include "kvs_tracked.hpp"
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace kvs_demo {
+
+struct MemoryStats {
+    static constexpr size_t type_count = static_cast<size_t>(KvsValue::Type::Object) + 1;
+
+    /// Value bytes by KvsValue::Type: the KvsValue itself plus its heap
+    /// data (string buffer, element array, object nodes and buckets).
+    std::array<size_t, type_count> by_type{};
+    size_t keys = 0;        ///< Key strings, top-level and inside objects
+    size_t index = 0;       ///< Map node links, cached hashes and buckets
+    size_t slack = 0;       ///< Allocator chunk headers and rounding
+    size_t entries = 0;
+    size_t allocations = 0;
+
+    size_t of(KvsValue::Type type) const { return by_type[static_cast<size_t>(type)]; }
+    size_t values() const;
+    size_t total() const { return values() + keys + index + slack; }
+
+    /// Short name of type, as in the store file ("i32", "str", "obj", ...).
+    static const char* typeName(KvsValue::Type type);
+};
+
+class MemoryAccounting : public KvsListener {
+public:
+    explicit MemoryAccounting(TrackedKvs& tracked);
+    ~MemoryAccounting() override;
+
+    MemoryAccounting(const MemoryAccounting&) = delete;
+    MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+
+    MemoryStats memory_stats() const;
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_reset() override;
+
+private:
+    // One key's share of the totals, kept to be subtracted again
+    struct Footprint {
+        std::array<size_t, MemoryStats::type_count> by_type{};
+        size_t keys = 0;
+        size_t index = 0;
+        size_t slack = 0;
+        size_t allocations = 0;
+    };
+
+    static Footprint measure(std::string_view key, const KvsValue& value);
+    void apply(const Footprint& footprint, bool add);
+
+    TrackedKvs& tracked;
+
+    mutable std::mutex mutex;
+    // Inserted in the same order as the store's map, so its bucket count
+    // follows the store's
+    std::unordered_map<std::string, Footprint> footprints;
+    MemoryStats totals;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_MEMORY_STATS_HPP
@@ -0,0 +1,327 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_metrics.cpp
+ * @brief Sharded counters, Prometheus rendering and the exporter thread
+ */
+
+#include "kvs_metrics.hpp"
+#include "kvs_snapshot_info.hpp"
+#include "kvs_store_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace kvs_demo {
+
+namespace {
+
+const std::vector<double> FLUSH_BUCKETS = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                                           0.01,   0.025,   0.05,   0.1,   0.25,   1.0};
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+    return buffer;
+}
+
+std::string seriesName(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    std::string all = labels.empty() ? extra : (extra.empty() ? labels : labels + "," + extra);
+    return all.empty() ? name : name + "{" + all + "}";
+}
+
+} // namespace
+
+MetricsRegistry::MetricsRegistry() : serial([] {
+    static std::atomic<uint64_t> next_serial{1};
+    return next_serial.fetch_add(1, std::memory_order_relaxed);
+}()) {}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type) {
+    for (auto& existing : families) {
+        if (existing.name == name) {
+            return existing;
+        }
+    }
+    families.push_back(Family{name, help, type, {}, {}});
+    return families.back();
+}
+
+std::optional<MetricsRegistry::CounterId> MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                                                   const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (next_counter >= MAX_COUNTERS) {
+        return std::nullopt;
+    }
+    CounterId id = next_counter++;
+    family(name, help, Type::Counter).series.push_back(Series{labels, id, nullptr});
+    return id;
+}
+
+std::optional<MetricsRegistry::HistogramId> MetricsRegistry::histogram(const std::string& name,
+                                                                       const std::string& help,
+                                                                       const std::string& labels,
+                                                                       const std::vector<double>& bounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // One counter per bucket plus +Inf, then the sum in nanoseconds and the count
+    size_t needed = bounds.size() + 3;
+    if (next_counter + needed > MAX_COUNTERS) {
+        return std::nullopt;
+    }
+    CounterId id = next_counter;
+    next_counter += needed;
+    Family& target = family(name, help, Type::Histogram);
+    target.bounds = bounds;
+    target.series.push_back(Series{labels, id, nullptr});
+    histogram_bounds.push_back(bounds);
+    return HistogramId{id, &histogram_bounds.back()};
+}
+
+MetricsRegistry::CallbackId MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                                                   const std::string& labels, std::function<double()> callback) {
+    return addCallback(name, help, Type::Gauge, labels, std::move(callback));
+}
+
+MetricsRegistry::CallbackId MetricsRegistry::callbackCounter(const std::string& name, const std::string& help,
+                                                             const std::string& labels,
+                                                             std::function<double()> callback) {
+    return addCallback(name, help, Type::Counter, labels, std::move(callback));
+}
+
+MetricsRegistry::CallbackId MetricsRegistry::addCallback(const std::string& name, const std::string& help, Type type,
+                                                         const std::string& labels,
+                                                         std::function<double()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    CallbackId id = next_callback++;
+    family(name, help, type).series.push_back(Series{labels, 0, std::move(callback), id});
+    return id;
+}
+
+void MetricsRegistry::removeCallback(CallbackId id) {
+    // render() calls the callbacks under the same mutex, so none is running once it is held
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto family = families.begin(); family != families.end(); ++family) {
+        auto& series = family->series;
+        auto found = std::find_if(series.begin(), series.end(),
+                                  [id](const Series& candidate) { return candidate.callback_id == id; });
+        if (found != series.end()) {
+            series.erase(found);
+            if (series.empty()) {
+                families.erase(family);
+            }
+            return;
+        }
+    }
+}
+
+MetricsRegistry::Shard& MetricsRegistry::localShard() {
+    // Registries are told apart by serial, so a cached entry never points into a reused address
+    thread_local std::vector<std::pair<uint64_t, Shard*>> known;
+    for (const auto& [owner, shard] : known) {
+        if (owner == serial) {
+            return *shard;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    shards.push_back(std::make_unique<Shard>());
+    known.emplace_back(serial, shards.back().get());
+    return *shards.back();
+}
+
+void MetricsRegistry::add(CounterId id, uint64_t amount) {
+    // Only this thread writes its shard, so no read-modify-write instruction is needed
+    auto& value = localShard().values[id];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::observe(const HistogramId& histogram, std::chrono::nanoseconds duration) {
+    const std::vector<double>& bounds = *histogram.bounds;
+    double seconds = std::chrono::duration<double>(duration).count();
+    size_t bucket = static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin());
+    add(histogram.first + bucket);
+    add(histogram.first + bounds.size() + 1, static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+    add(histogram.first + bounds.size() + 2);
+}
+
+uint64_t MetricsRegistry::sum(CounterId id) const {
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->values[id].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    for (const auto& family : families) {
+        static const char* type_names[] = {"counter", "gauge", "histogram"};
+        out += "# HELP " + family.name + " " + family.help + "\n";
+        out += "# TYPE " + family.name + " " + type_names[static_cast<int>(family.type)] + "\n";
+        for (const auto& series : family.series) {
+            if (series.callback) {
+                out += seriesName(family.name, series.labels) + " " + formatNumber(series.callback()) + "\n";
+            } else if (family.type != Type::Histogram) {
+                out += seriesName(family.name, series.labels) + " " + std::to_string(sum(series.first)) + "\n";
+            } else {
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i <= family.bounds.size(); ++i) {
+                    cumulative += sum(series.first + i);
+                    std::string bound = i < family.bounds.size() ? formatNumber(family.bounds[i]) : "+Inf";
+                    out += seriesName(family.name + "_bucket", series.labels, "le=\"" + bound + "\"") + " " +
+                           std::to_string(cumulative) + "\n";
+                }
+                double total_seconds = static_cast<double>(sum(series.first + family.bounds.size() + 1)) / 1e9;
+                out += seriesName(family.name + "_sum", series.labels) + " " + formatNumber(total_seconds) + "\n";
+                out += seriesName(family.name + "_count", series.labels) + " " +
+                       std::to_string(sum(series.first + family.bounds.size() + 2)) + "\n";
+            }
+        }
+    }
+    return out;
+}
+
+InstanceMetrics::InstanceMetrics(MetricsRegistry& registry, const std::string& dir, InstanceId instance_id,
+                                 const SnapshotInfoCache* snapshots)
+    : registry(registry) {
+    std::string instance = "instance=\"" + std::to_string(instance_id.id) + "\"";
+    const char* op_names[] = {"set", "get", "remove", "flush", "restore"};
+    for (size_t i = 0; i < operations.size(); ++i) {
+        operations[i] = registry.counter("kvs_operations_total", "KVS operations by type.",
+                                         instance + ",op=\"" + op_names[i] + "\"");
+    }
+    flush_duration = registry.histogram("kvs_flush_duration_seconds", "Duration of successful flushes.", instance,
+                                        FLUSH_BUCKETS);
+
+    std::string json_path = storePath(dir, instance_id.id, "0.json");
+    gauges.push_back(registry.gauge("kvs_store_bytes", "Size of the current store file.", instance, [json_path] {
+        struct stat info;
+        return ::stat(json_path.c_str(), &info) == 0 ? static_cast<double>(info.st_size) : 0.0;
+    }));
+    if (snapshots != nullptr) {
+        gauges.push_back(registry.gauge("kvs_snapshots", "Snapshots kept on disk.", instance,
+                                        [snapshots] { return static_cast<double>(snapshots->snapshot_count()); }));
+    }
+}
+
+InstanceMetrics::~InstanceMetrics() {
+    for (auto id : gauges) {
+        registry.removeCallback(id);
+    }
+}
+
+void InstanceMetrics::count(Op op) const {
+    if (auto id = operations[static_cast<size_t>(op)]) {
+        registry.add(*id);
+    }
+}
+
+void InstanceMetrics::flushed(std::chrono::nanoseconds duration) const {
+    if (flush_duration) {
+        registry.observe(*flush_duration, duration);
+    }
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry, Target target, const std::string& path,
+                                 std::chrono::milliseconds period)
+    : registry(registry), path(path), period(period) {
+    if (target == Target::File) {
+        worker = std::thread(&MetricsExporter::fileLoop, this);
+        return;
+    }
+
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        return;
+    }
+    ::unlink(path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd, 8) != 0) {
+        ::close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+    worker = std::thread(&MetricsExporter::socketLoop, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        worker.join();
+    }
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+    }
+}
+
+void MetricsExporter::fileLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        SyscallCounter counter;
+        writeFileAtomically(path, registry.render(), counter);
+        lock.lock();
+        wakeup.wait_for(lock, period, [this] { return stopping.load(); });
+    }
+}
+
+void MetricsExporter::socketLoop() {
+    // Poll with a short timeout so the destructor is not kept waiting for a client
+    while (!stopping) {
+        struct pollfd listener = {listen_fd, POLLIN, 0};
+        if (::poll(&listener, 1, 100) <= 0) {
+            continue;
+        }
+        int client = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        // Whatever the request says, the answer is the current rendering
+        struct pollfd request = {client, POLLIN, 0};
+        if (::poll(&request, 1, 100) > 0) {
+            char buffer[1024];
+            [[maybe_unused]] ssize_t ignored = ::recv(client, buffer, sizeof(buffer), MSG_DONTWAIT);
+        }
+        std::string body = registry.render();
+        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        ::close(client);
+    }
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,204 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_metrics.hpp
+ * @brief Per-instance metrics rendered in Prometheus text format
+ *
+ * MetricsRegistry holds metric families (counters, histograms and
+ * callback-backed gauges) and renders them in the Prometheus text
+ * exposition format. Counter increments are lock-free and uncontended:
+ * every thread writes its own shard with a relaxed load and store, and
+ * render() sums the shards. Shards outlive their threads, so counts never
+ * go backwards.
+ *
+ * InstanceMetrics registers the series of one instance and is attached to
+ * a TrackedKvs, which then counts its operations and times its flushes:
+ *
+ *   kvs_operations_total{instance,op}       set, get, remove, flush, restore
+ *   kvs_flush_duration_seconds{instance}    histogram
+ *   kvs_store_bytes{instance}               size of kvs_<id>_0.json
+ *   kvs_snapshots{instance}                 from a SnapshotInfoCache, if given
+ *
+ * MetricsExporter renders the registry from a background thread, either
+ * periodically into a file (for a textfile collector) or on each connection
+ * to a Unix socket, answered as a minimal HTTP response:
+ *
+ *   curl --unix-socket kvs_metrics.sock http://localhost/metrics
+ *
+ * Callbacks run on the exporter thread and must be safe to call from it.
+ * Whatever a callback reads must outlive its series: removeCallback() takes
+ * the series out and returns only once no render is running it, and
+ * InstanceMetrics removes its gauges that way when it is destroyed. Its
+ * counters stay in the registry with their last values.
+ */
+
+#ifndef KVS_DEMO_METRICS_HPP
+#define KVS_DEMO_METRICS_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+class SnapshotInfoCache;
+
+class MetricsRegistry {
+public:
+    using CounterId = size_t;
+    using CallbackId = size_t;
+    static constexpr size_t MAX_COUNTERS = 1024;
+
+    struct HistogramId {
+        CounterId first;
+        const std::vector<double>* bounds;
+    };
+
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /// Add a counter series; labels are preformatted, e.g. instance="3",op="set".
+    /// Returns nothing once MAX_COUNTERS slots are in use.
+    std::optional<CounterId> counter(const std::string& name, const std::string& help, const std::string& labels);
+
+    /// Add a histogram series over bucket upper bounds, in seconds.
+    std::optional<HistogramId> histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                       const std::vector<double>& bounds);
+
+    /// Add a series whose value is read from callback at render time.
+    CallbackId gauge(const std::string& name, const std::string& help, const std::string& labels,
+                     std::function<double()> callback);
+    CallbackId callbackCounter(const std::string& name, const std::string& help, const std::string& labels,
+                               std::function<double()> callback);
+
+    /// Remove a callback series; once this returns the callback is not
+    /// running and will not be called again.
+    void removeCallback(CallbackId id);
+
+    void add(CounterId id, uint64_t amount = 1);
+    void observe(const HistogramId& histogram, std::chrono::nanoseconds duration);
+
+    std::string render() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::string labels;
+        CounterId first = 0;
+        std::function<double()> callback;
+        CallbackId callback_id = 0;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<double> bounds;
+        std::vector<Series> series;
+    };
+
+    struct Shard {
+        std::array<std::atomic<uint64_t>, MAX_COUNTERS> values{};
+    };
+
+    Family& family(const std::string& name, const std::string& help, Type type);
+    CallbackId addCallback(const std::string& name, const std::string& help, Type type, const std::string& labels,
+                           std::function<double()> callback);
+    Shard& localShard();
+    uint64_t sum(CounterId id) const;
+
+    const uint64_t serial;
+    mutable std::mutex mutex;
+    std::vector<Family> families;
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t next_counter = 0;
+    CallbackId next_callback = 1;
+    // Bucket bounds handed out by histogram(); a deque keeps them in place
+    std::deque<std::vector<double>> histogram_bounds;
+};
+
+class InstanceMetrics {
+public:
+    enum class Op { Set, Get, Remove, Flush, Restore };
+
+    /// snapshots, if given, must outlive this object, which removes the
+    /// gauge reading it on destruction.
+    InstanceMetrics(MetricsRegistry& registry, const std::string& dir, InstanceId instance_id,
+                    const SnapshotInfoCache* snapshots = nullptr);
+    ~InstanceMetrics();
+
+    InstanceMetrics(const InstanceMetrics&) = delete;
+    InstanceMetrics& operator=(const InstanceMetrics&) = delete;
+
+    void count(Op op) const;
+    void flushed(std::chrono::nanoseconds duration) const;
+
+private:
+    MetricsRegistry& registry;
+    std::array<std::optional<MetricsRegistry::CounterId>, 5> operations;
+    std::optional<MetricsRegistry::HistogramId> flush_duration;
+    std::vector<MetricsRegistry::CallbackId> gauges;
+};
+
+class MetricsExporter {
+public:
+    enum class Target { File, UnixSocket };
+
+    /// File: rewrite path atomically every period. UnixSocket: listen on
+    /// path and answer each connection with the current rendering.
+    MetricsExporter(const MetricsRegistry& registry, Target target, const std::string& path,
+                    std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /// False if the socket could not be set up.
+    bool running() const { return worker.joinable(); }
+
+private:
+    void fileLoop();
+    void socketLoop();
+
+    const MetricsRegistry& registry;
+    std::string path;
+    std::chrono::milliseconds period;
+    int listen_fd = -1;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_METRICS_HPP
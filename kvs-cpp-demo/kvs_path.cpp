@@ -0,0 +1,208 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_path.cpp
+ * @brief Path parsing, lookup and copy-on-write updates of nested values
+ */
+
+#include "kvs_path.hpp"
+#include <memory>
+
+namespace kvs_demo {
+
+namespace {
+
+std::optional<size_t> parseIndex(const std::string& segment) {
+    if (segment.empty() || segment.size() > 18 || (segment.size() > 1 && segment[0] == '0')) {
+        return std::nullopt;
+    }
+    size_t index = 0;
+    for (char c : segment) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        index = index * 10 + static_cast<size_t>(c - '0');
+    }
+    return index;
+}
+
+/// Return a copy of node with the value at segments[depth..] replaced.
+std::optional<KvsValue> replaceAt(const KvsValue& node, const std::vector<std::string>& segments, size_t depth,
+                                  const KvsValue& value) {
+    const std::string& segment = segments[depth];
+    bool last = depth + 1 == segments.size();
+
+    if (node.getType() == KvsValue::Type::Object) {
+        KvsValue::Object object = std::get<KvsValue::Object>(node.getValue());
+        auto child = object.find(segment);
+        if (last) {
+            object[segment] = std::make_shared<KvsValue>(value);
+        } else {
+            if (child == object.end() || !child->second) {
+                return std::nullopt;
+            }
+            auto updated = replaceAt(*child->second, segments, depth + 1, value);
+            if (!updated) {
+                return std::nullopt;
+            }
+            child->second = std::make_shared<KvsValue>(std::move(*updated));
+        }
+        return KvsValue(object);
+    }
+
+    if (node.getType() == KvsValue::Type::Array) {
+        KvsValue::Array array = std::get<KvsValue::Array>(node.getValue());
+        if (last && segment == "-") {
+            array.push_back(std::make_shared<KvsValue>(value));
+            return KvsValue(array);
+        }
+        auto index = parseIndex(segment);
+        if (!index || *index >= array.size()) {
+            return std::nullopt;
+        }
+        if (last) {
+            array[*index] = std::make_shared<KvsValue>(value);
+        } else {
+            if (!array[*index]) {
+                return std::nullopt;
+            }
+            auto updated = replaceAt(*array[*index], segments, depth + 1, value);
+            if (!updated) {
+                return std::nullopt;
+            }
+            array[*index] = std::make_shared<KvsValue>(std::move(*updated));
+        }
+        return KvsValue(array);
+    }
+
+    return std::nullopt;
+}
+
+std::string joinPath(const std::vector<std::string>& segments) {
+    std::string path;
+    for (const auto& segment : segments) {
+        if (!path.empty()) {
+            path.push_back('/');
+        }
+        for (char c : segment) {
+            if (c == '~') {
+                path += "~0";
+            } else if (c == '/') {
+                path += "~1";
+            } else {
+                path.push_back(c);
+            }
+        }
+    }
+    return path;
+}
+
+} // namespace
+
+std::vector<std::string> parsePath(std::string_view path) {
+    if (!path.empty() && path.front() == '/') {
+        path.remove_prefix(1);
+    }
+
+    std::vector<std::string> segments(1);
+    for (size_t i = 0; i < path.size(); ++i) {
+        char c = path[i];
+        if (c == '/') {
+            segments.emplace_back();
+        } else if (c == '~' && i + 1 < path.size() && (path[i + 1] == '0' || path[i + 1] == '1')) {
+            segments.back().push_back(path[++i] == '0' ? '~' : '/');
+        } else {
+            segments.back().push_back(c);
+        }
+    }
+    return segments;
+}
+
+const KvsValue* findPath(const KvsValue& root, const std::vector<std::string>& segments, size_t first) {
+    const KvsValue* node = &root;
+    for (size_t i = first; i < segments.size() && node != nullptr; ++i) {
+        if (node->getType() == KvsValue::Type::Object) {
+            const auto& object = std::get<KvsValue::Object>(node->getValue());
+            auto child = object.find(segments[i]);
+            node = child == object.end() ? nullptr : child->second.get();
+        } else if (node->getType() == KvsValue::Type::Array) {
+            const auto& array = std::get<KvsValue::Array>(node->getValue());
+            auto index = parseIndex(segments[i]);
+            node = index && *index < array.size() ? array[*index].get() : nullptr;
+        } else {
+            node = nullptr;
+        }
+    }
+    return node;
+}
+
+void DirtyTracker::mark(std::string_view path) {
+    paths.insert(joinPath(parsePath(path)));
+}
+
+bool DirtyTracker::isDirty(std::string_view path) const {
+    std::string normalized = joinPath(parsePath(path));
+
+    // A write to the path itself or below it
+    if (paths.count(normalized) != 0) {
+        return true;
+    }
+    std::string prefix = normalized + "/";
+    auto below = paths.lower_bound(prefix);
+    if (below != paths.end() && below->compare(0, prefix.size(), prefix) == 0) {
+        return true;
+    }
+
+    // A write that replaced a subtree containing the path
+    for (size_t slash = normalized.find('/'); slash != std::string::npos; slash = normalized.find('/', slash + 1)) {
+        if (paths.count(std::string_view(normalized).substr(0, slash)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<KvsValue> get_path(Kvs& kvs, std::string_view path) {
+    auto segments = parsePath(path);
+    auto value_result = kvs.get_value(segments.front());
+    if (!value_result) {
+        return std::nullopt;
+    }
+    const KvsValue* found = findPath(value_result.value(), segments);
+    if (found == nullptr) {
+        return std::nullopt;
+    }
+    return *found;
+}
+
+bool set_path(Kvs& kvs, std::string_view path, const KvsValue& value, DirtyTracker* dirty) {
+    auto segments = parsePath(path);
+    bool ok = false;
+    if (segments.size() == 1) {
+        ok = static_cast<bool>(kvs.set_value(segments.front(), value));
+    } else {
+        auto value_result = kvs.get_value(segments.front());
+        if (!value_result) {
+            return false;
+        }
+        auto updated = replaceAt(value_result.value(), segments, 1, value);
+        ok = updated && kvs.set_value(segments.front(), *updated);
+    }
+    if (ok && dirty != nullptr) {
+        dirty->mark(path);
+    }
+    return ok;
+}
+
+} // namespace kvs_demo
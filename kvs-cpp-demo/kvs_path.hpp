@@ -0,0 +1,71 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_path.hpp
+ * @brief JSON-pointer style access to values nested in Objects and Arrays
+ *
+ * A path is the KVS key followed by JSON pointer segments (RFC 6901), e.g.
+ * "device_config/location" or "sensors/0/name"; "~1" stands for '/' and
+ * "~0" for '~' inside a segment. Array segments are indices, and "-" appends.
+ *
+ * KvsValue containers hold shared_ptr children, so set_path() copies only
+ * the containers on the way down and links the untouched siblings into the
+ * new tree: an edit costs O(depth) container copies instead of a deep copy
+ * of the whole object. Shared children are never modified in place.
+ */
+
+#ifndef KVS_DEMO_PATH_HPP
+#define KVS_DEMO_PATH_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+/// Split a path into its unescaped segments; the first one is the KVS key.
+std::vector<std::string> parsePath(std::string_view path);
+
+/// Find the value at segments [first, segments.size()) below root.
+const KvsValue* findPath(const KvsValue& root, const std::vector<std::string>& segments, size_t first = 1);
+
+/// Remembers which subtrees were written since the last clear().
+class DirtyTracker {
+public:
+    void mark(std::string_view path);
+
+    /// True if path, anything below it, or a subtree containing it was written.
+    bool isDirty(std::string_view path) const;
+
+    std::vector<std::string> dirtyPaths() const { return {paths.begin(), paths.end()}; }
+    void clear() { paths.clear(); }
+
+private:
+    std::set<std::string, std::less<>> paths;
+};
+
+std::optional<KvsValue> get_path(Kvs& kvs, std::string_view path);
+
+/// Replace (or add, for the last Object member or "-" Array segment) the
+/// value at path. Intermediate containers must exist.
+bool set_path(Kvs& kvs, std::string_view path, const KvsValue& value, DirtyTracker* dirty = nullptr);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_PATH_HPP
@@ -0,0 +1,55 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_persistent.cpp
+ * @brief Conversions between KvsValue containers and persistent containers
+ */
+
+#include "kvs_persistent.hpp"
+
+namespace kvs_demo {
+
+PersistentObject toPersistent(const KvsValue::Object& object) {
+    PersistentObject result;
+    for (const auto& [key, value] : object) {
+        result = result.set(key, value);
+    }
+    return result;
+}
+
+PersistentArray toPersistent(const KvsValue::Array& array) {
+    PersistentArray result;
+    for (const auto& value : array) {
+        result = result.push_back(value);
+    }
+    return result;
+}
+
+KvsValue::Object toObject(const PersistentObject& object) {
+    KvsValue::Object result;
+    result.reserve(object.size());
+    object.forEach([&result](const std::string& key, const ValuePtr& value) {
+        result.emplace(key, std::const_pointer_cast<KvsValue>(value));
+    });
+    return result;
+}
+
+KvsValue::Array toArray(const PersistentArray& array) {
+    KvsValue::Array result;
+    result.reserve(array.size());
+    array.forEach([&result](const ValuePtr& value) { result.push_back(std::const_pointer_cast<KvsValue>(value)); });
+    return result;
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,413 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_persistent.hpp
+ * @brief Immutable map and vector with structural sharing
+ *
+ * PersistentMap is a hash array mapped trie (Bagwell, "Ideal Hash Trees"):
+ * 32-way nodes indexed by 5 bits of the key hash, with a bitmap so that only
+ * occupied slots are stored. PersistentVector is a 32-way bit-partitioned
+ * trie with a tail buffer, as in Clojure's vector; it does not implement the
+ * relaxed (RRB) nodes needed for O(log n) concatenation and slicing.
+ *
+ * Both are values: copying one copies a pointer, and every update returns a
+ * new version that shares all untouched nodes with the old one, so copies
+ * and snapshots are O(1) and updates O(log n).
+ */
+
+#ifndef KVS_DEMO_PERSISTENT_HPP
+#define KVS_DEMO_PERSISTENT_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+template <typename V>
+class PersistentMap {
+public:
+    PersistentMap() = default;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const V* find(const std::string& key) const {
+        uint64_t hash = hashKey(key);
+        const Node* node = root.get();
+        for (unsigned shift = 0; node != nullptr; shift += BITS) {
+            if (shift >= HASH_BITS) {
+                for (const auto& entry : node->collisions) {
+                    if (entry->key == key) {
+                        return &entry->value;
+                    }
+                }
+                return nullptr;
+            }
+            uint32_t bit = 1u << ((hash >> shift) & MASK);
+            if ((node->bitmap & bit) == 0) {
+                return nullptr;
+            }
+            const Child& child = node->children[slotOf(node->bitmap, bit)];
+            if (child.entry) {
+                return child.entry->key == key ? &child.entry->value : nullptr;
+            }
+            node = child.node.get();
+        }
+        return nullptr;
+    }
+
+    PersistentMap set(const std::string& key, V value) const {
+        bool added = false;
+        auto entry = std::make_shared<const Entry>(Entry{key, std::move(value), hashKey(key)});
+        NodePtr new_root = insert(root, 0, entry, added);
+        return PersistentMap(std::move(new_root), count + (added ? 1 : 0));
+    }
+
+    PersistentMap erase(const std::string& key) const {
+        bool removed = false;
+        Child result = remove(root, 0, hashKey(key), key, removed);
+        if (!removed) {
+            return *this;
+        }
+        // A lone entry left at the top still needs a node around it
+        NodePtr new_root = result.node;
+        if (result.entry) {
+            bool added = false;
+            new_root = insert(nullptr, 0, result.entry, added);
+        }
+        return PersistentMap(new_root, count - 1);
+    }
+
+    /// Visit every entry, in hash order.
+    void forEach(const std::function<void(const std::string&, const V&)>& visit) const {
+        walk(root.get(), visit);
+    }
+
+private:
+    static constexpr unsigned BITS = 5;
+    static constexpr uint64_t MASK = (1u << BITS) - 1;
+    static constexpr unsigned HASH_BITS = 64;
+
+    struct Entry {
+        std::string key;
+        V value;
+        uint64_t hash;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Exactly one of entry and node is set
+    struct Child {
+        EntryPtr entry;
+        NodePtr node;
+    };
+
+    struct Node {
+        uint32_t bitmap = 0;
+        std::vector<Child> children;
+        // Only used below the last hash level, for full hash collisions
+        std::vector<EntryPtr> collisions;
+    };
+
+    PersistentMap(NodePtr root, size_t count) : root(std::move(root)), count(count) {}
+
+    static uint64_t hashKey(const std::string& key) { return static_cast<uint64_t>(std::hash<std::string>{}(key)); }
+
+    static size_t slotOf(uint32_t bitmap, uint32_t bit) {
+        return static_cast<size_t>(__builtin_popcount(bitmap & (bit - 1)));
+    }
+
+    static NodePtr insert(const NodePtr& node, unsigned shift, const EntryPtr& entry, bool& added) {
+        if (shift >= HASH_BITS) {
+            auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+            for (auto& existing : copy->collisions) {
+                if (existing->key == entry->key) {
+                    existing = entry;
+                    return copy;
+                }
+            }
+            copy->collisions.push_back(entry);
+            added = true;
+            return copy;
+        }
+
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        uint32_t bit = 1u << ((entry->hash >> shift) & MASK);
+        size_t slot = slotOf(copy->bitmap, bit);
+
+        if ((copy->bitmap & bit) == 0) {
+            copy->bitmap |= bit;
+            copy->children.insert(copy->children.begin() + static_cast<std::ptrdiff_t>(slot), Child{entry, nullptr});
+            added = true;
+            return copy;
+        }
+
+        Child& child = copy->children[slot];
+        if (child.entry) {
+            if (child.entry->key == entry->key) {
+                child.entry = entry;
+                return copy;
+            }
+            // Two entries share this slot: push both one level down
+            bool ignored = false;
+            NodePtr sub = insert(nullptr, shift + BITS, child.entry, ignored);
+            child = Child{nullptr, insert(sub, shift + BITS, entry, added)};
+            return copy;
+        }
+
+        child.node = insert(child.node, shift + BITS, entry, added);
+        return copy;
+    }
+
+    /// Returns the replacement for node: a node, a single entry to be pulled
+    /// up into the parent, or nothing if the node became empty.
+    static Child remove(const NodePtr& node, unsigned shift, uint64_t hash, const std::string& key, bool& removed) {
+        if (!node) {
+            return Child{};
+        }
+
+        if (shift >= HASH_BITS) {
+            auto copy = std::make_shared<Node>(*node);
+            for (auto it = copy->collisions.begin(); it != copy->collisions.end(); ++it) {
+                if ((*it)->key == key) {
+                    copy->collisions.erase(it);
+                    removed = true;
+                    break;
+                }
+            }
+            if (!removed) {
+                return Child{nullptr, node};
+            }
+            if (copy->collisions.size() == 1) {
+                return Child{copy->collisions.front(), nullptr};
+            }
+            return copy->collisions.empty() ? Child{} : Child{nullptr, copy};
+        }
+
+        uint32_t bit = 1u << ((hash >> shift) & MASK);
+        if ((node->bitmap & bit) == 0) {
+            return Child{nullptr, node};
+        }
+        size_t slot = slotOf(node->bitmap, bit);
+        const Child& child = node->children[slot];
+
+        Child replacement;
+        if (child.entry) {
+            if (child.entry->key != key) {
+                return Child{nullptr, node};
+            }
+            removed = true;
+        } else {
+            replacement = remove(child.node, shift + BITS, hash, key, removed);
+            if (!removed) {
+                return Child{nullptr, node};
+            }
+        }
+
+        auto copy = std::make_shared<Node>(*node);
+        if (!replacement.entry && !replacement.node) {
+            copy->bitmap &= ~bit;
+            copy->children.erase(copy->children.begin() + static_cast<std::ptrdiff_t>(slot));
+        } else {
+            copy->children[slot] = replacement;
+        }
+
+        if (copy->children.empty()) {
+            return Child{};
+        }
+        // Collapse a node that only holds one entry into its parent
+        if (shift > 0 && copy->children.size() == 1 && copy->children.front().entry) {
+            return Child{copy->children.front().entry, nullptr};
+        }
+        return Child{nullptr, copy};
+    }
+
+    static void walk(const Node* node, const std::function<void(const std::string&, const V&)>& visit) {
+        if (node == nullptr) {
+            return;
+        }
+        for (const auto& entry : node->collisions) {
+            visit(entry->key, entry->value);
+        }
+        for (const auto& child : node->children) {
+            if (child.entry) {
+                visit(child.entry->key, child.entry->value);
+            } else {
+                walk(child.node.get(), visit);
+            }
+        }
+    }
+
+    NodePtr root;
+    size_t count = 0;
+};
+
+template <typename V>
+class PersistentVector {
+public:
+    PersistentVector() = default;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /// Element i; i must be below size().
+    const V& operator[](size_t i) const { return leafFor(i)[i & MASK]; }
+
+    PersistentVector push_back(V value) const {
+        PersistentVector result(*this);
+        if (count - tailOffset() < WIDTH) {
+            auto tail_copy = std::make_shared<std::vector<V>>(*tail);
+            tail_copy->push_back(std::move(value));
+            result.tail = tail_copy;
+            ++result.count;
+            return result;
+        }
+
+        // The tail is full: move it into the trie and start a new one
+        auto leaf = std::make_shared<Node>();
+        leaf->values = *tail;
+        if ((count >> BITS) > (size_t{1} << shift)) {
+            auto new_root = std::make_shared<Node>();
+            new_root->children.push_back(root);
+            new_root->children.push_back(newPath(shift, leaf));
+            result.root = new_root;
+            result.shift = shift + BITS;
+        } else {
+            result.root = pushTail(shift, root, leaf);
+        }
+        result.tail = std::make_shared<std::vector<V>>(std::vector<V>{std::move(value)});
+        ++result.count;
+        return result;
+    }
+
+    /// Copy with element i replaced; unchanged if i is not below size().
+    PersistentVector set(size_t i, V value) const {
+        if (i >= count) {
+            return *this;
+        }
+        PersistentVector result(*this);
+        if (i >= tailOffset()) {
+            auto tail_copy = std::make_shared<std::vector<V>>(*tail);
+            (*tail_copy)[i & MASK] = std::move(value);
+            result.tail = tail_copy;
+        } else {
+            result.root = assoc(shift, root, i, std::move(value));
+        }
+        return result;
+    }
+
+    void forEach(const std::function<void(const V&)>& visit) const {
+        for (size_t i = 0; i < count; i += WIDTH) {
+            const auto& leaf = leafFor(i);
+            for (const auto& value : leaf) {
+                visit(value);
+            }
+        }
+    }
+
+private:
+    static constexpr unsigned BITS = 5;
+    static constexpr size_t WIDTH = size_t{1} << BITS;
+    static constexpr size_t MASK = WIDTH - 1;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        std::vector<NodePtr> children;
+        std::vector<V> values;
+    };
+
+    size_t tailOffset() const { return count < WIDTH ? 0 : ((count - 1) >> BITS) << BITS; }
+
+    const std::vector<V>& leafFor(size_t i) const {
+        if (i >= tailOffset()) {
+            return *tail;
+        }
+        const Node* node = root.get();
+        for (unsigned level = shift; level > 0; level -= BITS) {
+            node = node->children[(i >> level) & MASK].get();
+        }
+        return node->values;
+    }
+
+    static NodePtr newPath(unsigned level, NodePtr leaf) {
+        for (; level > 0; level -= BITS) {
+            auto parent = std::make_shared<Node>();
+            parent->children.push_back(std::move(leaf));
+            leaf = parent;
+        }
+        return leaf;
+    }
+
+    NodePtr pushTail(unsigned level, const NodePtr& parent, NodePtr leaf) const {
+        auto copy = std::make_shared<Node>(*parent);
+        size_t index = ((count - 1) >> level) & MASK;
+        NodePtr child;
+        if (level == BITS) {
+            child = std::move(leaf);
+        } else if (index < copy->children.size()) {
+            child = pushTail(level - BITS, copy->children[index], std::move(leaf));
+        } else {
+            child = newPath(level - BITS, std::move(leaf));
+        }
+        if (index < copy->children.size()) {
+            copy->children[index] = child;
+        } else {
+            copy->children.push_back(child);
+        }
+        return copy;
+    }
+
+    static NodePtr assoc(unsigned level, const NodePtr& node, size_t i, V value) {
+        auto copy = std::make_shared<Node>(*node);
+        if (level == 0) {
+            copy->values[i & MASK] = std::move(value);
+        } else {
+            size_t index = (i >> level) & MASK;
+            copy->children[index] = assoc(level - BITS, node->children[index], i, std::move(value));
+        }
+        return copy;
+    }
+
+    size_t count = 0;
+    unsigned shift = BITS;
+    NodePtr root = std::make_shared<const Node>();
+    std::shared_ptr<const std::vector<V>> tail = std::make_shared<const std::vector<V>>();
+};
+
+using ValuePtr = std::shared_ptr<const KvsValue>;
+using PersistentObject = PersistentMap<ValuePtr>;
+using PersistentArray = PersistentVector<ValuePtr>;
+
+/// Convert between KvsValue containers and their persistent counterparts.
+/// Children are shared, not copied.
+PersistentObject toPersistent(const KvsValue::Object& object);
+PersistentArray toPersistent(const KvsValue::Array& array);
+KvsValue::Object toObject(const PersistentObject& object);
+KvsValue::Array toArray(const PersistentArray& array);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_PERSISTENT_HPP
@@ -0,0 +1,50 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_probes.cpp
+ * @brief Probe semaphores and the traced build
+ */
+
+#include "kvs_probes.hpp"
+#include "kvs_trace.hpp"
+
+#ifdef KVS_DEMO_HAVE_USDT
+// Tracers find the semaphores through the probe notes and increment them
+// while attached; they must live in the .probes section.
+extern "C" {
+__attribute__((section(".probes"))) volatile unsigned short kvs_demo_set_value_semaphore = 0;
+__attribute__((section(".probes"))) volatile unsigned short kvs_demo_get_value_semaphore = 0;
+__attribute__((section(".probes"))) volatile unsigned short kvs_demo_flush_semaphore = 0;
+__attribute__((section(".probes"))) volatile unsigned short kvs_demo_snapshot_restore_semaphore = 0;
+__attribute__((section(".probes"))) volatile unsigned short kvs_demo_build_semaphore = 0;
+}
+#endif
+
+namespace kvs_demo {
+
+score::Result<Kvs> tracedBuild(InstanceId instance_id, const std::string& dir, bool need_defaults, bool need_kvs) {
+    TraceSpan span("build", "kvs", static_cast<int64_t>(instance_id.id));
+    ProbeTimer timer(KVS_PROBE_ENABLED(build));
+    auto result = KvsBuilder(instance_id)
+        .need_defaults_flag(need_defaults)
+        .need_kvs_flag(need_kvs)
+        .dir(std::string(dir))
+        .build();
+    if (KVS_PROBE_ENABLED(build)) {
+        KVS_PROBE2(build, instance_id.id, timer.elapsed_ns());
+    }
+    return result;
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,105 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_probes.hpp
+ * @brief USDT tracepoints on the demo's KVS hot paths
+ *
+ * With systemtap's <sys/sdt.h> available, the probes below are compiled in
+ * as USDT probes of provider "kvs_demo" with one semaphore each. A probe
+ * site is a single nop until a tracer attaches and bumps the semaphore; the
+ * timestamps feeding the duration argument are only taken while it is
+ * non-zero. Without <sys/sdt.h> everything compiles away.
+ *
+ *   probe             arguments
+ *   set_value         instance id, key length, duration (ns)
+ *   get_value         instance id, key length, duration (ns)
+ *   flush             instance id, duration (ns)
+ *   snapshot_restore  instance id, snapshot id, duration (ns)
+ *   build             instance id, duration (ns)
+ *
+ * Example:
+ *   bpftrace -e 'usdt:./kvs_demo:kvs_demo:set_value { @ns[arg0] = hist(arg2); }'
+ */
+
+#ifndef KVS_DEMO_PROBES_HPP
+#define KVS_DEMO_PROBES_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define KVS_DEMO_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef KVS_DEMO_HAVE_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+extern "C" {
+extern volatile unsigned short kvs_demo_set_value_semaphore;
+extern volatile unsigned short kvs_demo_get_value_semaphore;
+extern volatile unsigned short kvs_demo_flush_semaphore;
+extern volatile unsigned short kvs_demo_snapshot_restore_semaphore;
+extern volatile unsigned short kvs_demo_build_semaphore;
+}
+
+#define KVS_PROBE_ENABLED(name) __builtin_expect(kvs_demo_##name##_semaphore != 0, 0)
+#define KVS_PROBE2(name, a1, a2) DTRACE_PROBE2(kvs_demo, name, a1, a2)
+#define KVS_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(kvs_demo, name, a1, a2, a3)
+#else
+#define KVS_PROBE_ENABLED(name) false
+#define KVS_PROBE2(name, a1, a2) do {} while (0)
+#define KVS_PROBE3(name, a1, a2, a3) do {} while (0)
+#endif
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+constexpr bool probes_compiled_in =
+#ifdef KVS_DEMO_HAVE_USDT
+    true;
+#else
+    false;
+#endif
+
+/// Measures a probe's duration argument, reading the clock only if the
+/// probe was enabled when the operation started.
+class ProbeTimer {
+public:
+    explicit ProbeTimer(bool enabled)
+        : start(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+    uint64_t elapsed_ns() const {
+        if (start == std::chrono::steady_clock::time_point{}) {
+            return 0;
+        }
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+/// KvsBuilder(instance_id)...build() with the build probe around it.
+score::Result<Kvs> tracedBuild(InstanceId instance_id, const std::string& dir, bool need_defaults, bool need_kvs);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_PROBES_HPP
@@ -0,0 +1,280 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_replay.cpp
+ * @brief Buffered operation recording, trace decoding and replay
+ */
+
+#include "kvs_replay.hpp"
+#include "kvs_value_codec.hpp"
+#include <iterator>
+
+namespace kvs_demo {
+
+namespace {
+
+constexpr char trace_magic[4] = {'K', 'V', 'S', 'R'};
+constexpr uint32_t trace_version = 1;
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+bool getU32(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+    if (end - data < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    data += 4;
+    return true;
+}
+
+bool getU64(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+    if (end - data < 8) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    data += 8;
+    return true;
+}
+
+bool hasKey(RecordedOp op) {
+    return op == RecordedOp::Set || op == RecordedOp::Get || op == RecordedOp::Remove ||
+           op == RecordedOp::ResetKey;
+}
+
+} // namespace
+
+const char* to_string(RecordedOp op) {
+    switch (op) {
+        case RecordedOp::Set: return "set_value";
+        case RecordedOp::Get: return "get_value";
+        case RecordedOp::Remove: return "remove_key";
+        case RecordedOp::ResetKey: return "reset_key";
+        case RecordedOp::Reset: return "reset";
+        case RecordedOp::Flush: return "flush";
+        case RecordedOp::Restore: return "snapshot_restore";
+    }
+    return "unknown";
+}
+
+OperationRecorder::OperationRecorder(const std::string& path, InstanceId instance_id, size_t buffer_bytes)
+    : file(path, std::ios::binary | std::ios::trunc),
+      buffer_limit(buffer_bytes),
+      start(std::chrono::steady_clock::now()) {
+    pending.append(trace_magic, sizeof(trace_magic));
+    putU32(pending, trace_version);
+    putU64(pending, instance_id.id);
+    if (!file) {
+        healthy = false;
+    }
+    writer = std::thread(&OperationRecorder::writerLoop, this);
+}
+
+OperationRecorder::~OperationRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    writer.join();
+}
+
+void OperationRecorder::record(RecordedOp op, std::string_view key, const KvsValue* value, size_t snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Taken under the lock, so offsets never go backwards in the file
+    auto offset = std::chrono::steady_clock::now() - start;
+    size_t record_start = pending.size();
+    pending.push_back(static_cast<char>(op));
+    putU64(pending, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(offset).count()));
+    if (hasKey(op)) {
+        putU32(pending, static_cast<uint32_t>(key.size()));
+        pending.append(key.data(), key.size());
+    }
+    if (op == RecordedOp::Set) {
+        size_t length_at = pending.size();
+        putU32(pending, 0);
+        if (!encodeValue(*value, pending)) {
+            // Too deeply nested for the codec; keep the rest of the recording loadable
+            pending.resize(record_start);
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint32_t length = static_cast<uint32_t>(pending.size() - length_at - 4);
+        for (int i = 0; i < 4; ++i) {
+            pending[length_at + i] = static_cast<char>(length >> (8 * i));
+        }
+    } else if (op == RecordedOp::Restore) {
+        putU64(pending, snapshot);
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+    if (pending.size() >= buffer_limit) {
+        wakeup.notify_one();
+    }
+}
+
+bool OperationRecorder::sync() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = handed_over + (pending.empty() ? 0 : 1);
+    wakeup.notify_one();
+    written.wait(lock, [this, target] { return completed >= target; });
+    return ok();
+}
+
+void OperationRecorder::writerLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // sync() wakes the writer with a partial buffer and waits for it
+        wakeup.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            break;
+        }
+        batch.swap(pending);
+        ++handed_over;
+        lock.unlock();
+
+        if (file && !file.write(batch.data(), static_cast<std::streamsize>(batch.size())).flush()) {
+            healthy = false;
+        }
+        batch.clear();
+
+        lock.lock();
+        ++completed;
+        written.notify_all();
+    }
+}
+
+std::optional<OperationTrace> OperationTrace::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+    const uint8_t* end = data + contents.size();
+
+    uint32_t version = 0;
+    uint64_t instance = 0;
+    if (contents.compare(0, sizeof(trace_magic), trace_magic, sizeof(trace_magic)) != 0) {
+        return std::nullopt;
+    }
+    data += sizeof(trace_magic);
+    if (!getU32(data, end, version) || version != trace_version || !getU64(data, end, instance)) {
+        return std::nullopt;
+    }
+
+    OperationTrace trace;
+    trace.instance_id = static_cast<size_t>(instance);
+    while (data < end) {
+        uint8_t op = *data++;
+        uint64_t offset = 0;
+        if (op >= recorded_op_count || !getU64(data, end, offset)) {
+            return std::nullopt;
+        }
+        RecordedOperation operation{static_cast<RecordedOp>(op), std::chrono::nanoseconds(offset), {}, std::nullopt};
+        if (hasKey(operation.op)) {
+            uint32_t key_size = 0;
+            if (!getU32(data, end, key_size) || static_cast<size_t>(end - data) < key_size) {
+                return std::nullopt;
+            }
+            operation.key.assign(reinterpret_cast<const char*>(data), key_size);
+            data += key_size;
+        }
+        if (operation.op == RecordedOp::Set) {
+            uint32_t value_size = 0;
+            if (!getU32(data, end, value_size) || static_cast<size_t>(end - data) < value_size) {
+                return std::nullopt;
+            }
+            operation.value = decodeValue(data, value_size);
+            if (!operation.value) {
+                return std::nullopt;
+            }
+            data += value_size;
+        } else if (operation.op == RecordedOp::Restore) {
+            uint64_t snapshot = 0;
+            if (!getU64(data, end, snapshot)) {
+                return std::nullopt;
+            }
+            operation.snapshot = static_cast<size_t>(snapshot);
+        }
+        trace.ops.push_back(std::move(operation));
+    }
+    return trace;
+}
+
+std::chrono::nanoseconds OperationTrace::duration() const {
+    return ops.empty() ? std::chrono::nanoseconds(0) : ops.back().offset;
+}
+
+ReplayStats replay(const OperationTrace& trace, Kvs& kvs, ReplayPacing pacing) {
+    ReplayStats stats;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& operation : trace.operations()) {
+        if (pacing == ReplayPacing::Recorded) {
+            std::this_thread::sleep_until(start + operation.offset);
+        }
+
+        auto call_start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+        switch (operation.op) {
+            case RecordedOp::Set:
+                succeeded = static_cast<bool>(kvs.set_value(operation.key, *operation.value));
+                break;
+            case RecordedOp::Get:
+                succeeded = static_cast<bool>(kvs.get_value(operation.key));
+                break;
+            case RecordedOp::Remove:
+                succeeded = static_cast<bool>(kvs.remove_key(operation.key));
+                break;
+            case RecordedOp::ResetKey:
+                succeeded = static_cast<bool>(kvs.reset_key(operation.key));
+                break;
+            case RecordedOp::Reset:
+                succeeded = static_cast<bool>(kvs.reset());
+                break;
+            case RecordedOp::Flush:
+                succeeded = static_cast<bool>(kvs.flush());
+                break;
+            case RecordedOp::Restore:
+                succeeded = static_cast<bool>(kvs.snapshot_restore(SnapshotId(operation.snapshot)));
+                break;
+        }
+        auto op = static_cast<size_t>(operation.op);
+        stats.time[op] += std::chrono::steady_clock::now() - call_start;
+        ++stats.count[op];
+        ++stats.operations;
+        if (!succeeded) {
+            ++stats.errors;
+        }
+    }
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+} // namespace kvs_demo
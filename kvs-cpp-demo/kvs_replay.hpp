@@ -0,0 +1,148 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_replay.hpp
+ * @brief Binary recording of KVS operations and their replay
+ *
+ * An OperationRecorder attached to a TrackedKvs logs every call (set_value,
+ * get_value, remove_key, reset_key, reset, flush, snapshot_restore) with its
+ * arguments and its start time. A call only appends its record to an
+ * in-memory buffer; a background thread writes full buffers to the file,
+ * so the recorded workload does not wait on disk I/O.
+ *
+ * File layout, integers little-endian:
+ *   header: "KVSR", u32 version, u64 instance id
+ *   record: u8 op, u64 ns since the recorder was created, then
+ *           - key ops: u32 key length + key bytes
+ *           - set:     key, u32 value length + value (kvs_value_codec.hpp)
+ *           - restore: u64 snapshot id
+ *
+ * OperationTrace::load() decodes a whole file up front, and replay() runs
+ * it against a Kvs, either at the recorded pace or back to back, timing
+ * each call. Replaying into an empty instance reproduces the recorded
+ * contents, so the same traffic can be run against different builds.
+ */
+
+#ifndef KVS_DEMO_REPLAY_HPP
+#define KVS_DEMO_REPLAY_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+enum class RecordedOp : uint8_t { Set, Get, Remove, ResetKey, Reset, Flush, Restore };
+
+constexpr size_t recorded_op_count = static_cast<size_t>(RecordedOp::Restore) + 1;
+
+const char* to_string(RecordedOp op);
+
+class OperationRecorder {
+public:
+    OperationRecorder(const std::string& path, InstanceId instance_id, size_t buffer_bytes = 64 * 1024);
+    ~OperationRecorder();
+
+    OperationRecorder(const OperationRecorder&) = delete;
+    OperationRecorder& operator=(const OperationRecorder&) = delete;
+
+    /// Append one call; value is used for Set, snapshot for Restore.
+    void record(RecordedOp op, std::string_view key = {}, const KvsValue* value = nullptr, size_t snapshot = 0);
+
+    /// Hand the buffered records to the writer and wait until they are in the file.
+    bool sync();
+
+    /// False once opening or writing the file failed.
+    bool ok() const { return healthy.load(std::memory_order_relaxed); }
+    size_t recorded() const { return count.load(std::memory_order_relaxed); }
+
+    /// set_value() calls left out because the value nests too deeply to encode.
+    size_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    void writerLoop();
+
+    std::ofstream file;
+    size_t buffer_limit;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable written;
+    std::string pending;
+    uint64_t handed_over = 0;
+    uint64_t completed = 0;
+    bool stopping = false;
+    std::atomic<bool> healthy{true};
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped_count{0};
+    std::thread writer;
+};
+
+struct RecordedOperation {
+    RecordedOp op;
+    std::chrono::nanoseconds offset;
+    std::string key;
+    std::optional<KvsValue> value;
+    size_t snapshot = 0;
+};
+
+class OperationTrace {
+public:
+    /// Decode a recording; nothing if the file is missing or malformed.
+    static std::optional<OperationTrace> load(const std::string& path);
+
+    size_t instance() const { return instance_id; }
+    const std::vector<RecordedOperation>& operations() const { return ops; }
+
+    /// Start time of the last call.
+    std::chrono::nanoseconds duration() const;
+
+private:
+    size_t instance_id = 0;
+    std::vector<RecordedOperation> ops;
+};
+
+enum class ReplayPacing {
+    Recorded,           ///< Start each call at its recorded offset
+    AsFastAsPossible,   ///< Back to back
+};
+
+struct ReplayStats {
+    size_t operations = 0;
+    size_t errors = 0;                                                ///< Calls that returned an error
+    std::chrono::nanoseconds elapsed{0};
+    std::array<size_t, recorded_op_count> count{};
+    std::array<std::chrono::nanoseconds, recorded_op_count> time{};   ///< Time spent in the calls
+};
+
+/// Run trace against kvs, usually a freshly reset instance.
+ReplayStats replay(const OperationTrace& trace, Kvs& kvs, ReplayPacing pacing);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_REPLAY_HPP
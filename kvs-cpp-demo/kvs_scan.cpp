@@ -0,0 +1,221 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_scan.cpp
+ * @brief Predicate combinators and the snapshot-based scan
+ */
+
+#include "kvs_scan.hpp"
+#include "kvs_path.hpp"
+#include "kvs_value_codec.hpp"
+#include <optional>
+
+namespace kvs_demo {
+
+namespace {
+
+std::optional<NumericBound> asNumber(const KvsValue& value) {
+    switch (value.getType()) {
+        case KvsValue::Type::i32:
+            return NumericBound(std::get<int32_t>(value.getValue()));
+        case KvsValue::Type::u32:
+            return NumericBound(std::get<uint32_t>(value.getValue()));
+        case KvsValue::Type::i64:
+            return NumericBound(std::get<int64_t>(value.getValue()));
+        case KvsValue::Type::u64:
+            return NumericBound(std::get<uint64_t>(value.getValue()));
+        case KvsValue::Type::f64:
+            return NumericBound(std::get<double>(value.getValue()));
+        default:
+            return std::nullopt;
+    }
+}
+
+double toDouble(const NumericBound& number) {
+    switch (number.kind) {
+        case NumericBound::Kind::Signed:
+            return static_cast<double>(number.signed_value);
+        case NumericBound::Kind::Unsigned:
+            return static_cast<double>(number.unsigned_value);
+        case NumericBound::Kind::Real:
+            break;
+    }
+    return number.real;
+}
+
+/// -1, 0 or 1 as a is below, equal to or above b; nothing if unordered (NaN).
+std::optional<int> compare(const NumericBound& a, const NumericBound& b) {
+    using Kind = NumericBound::Kind;
+    if (a.kind == Kind::Real || b.kind == Kind::Real) {
+        double x = toDouble(a);
+        double y = toDouble(b);
+        if (x != x || y != y) {
+            return std::nullopt;
+        }
+        return x < y ? -1 : x > y ? 1 : 0;
+    }
+    if (a.kind == Kind::Signed && b.kind == Kind::Signed) {
+        return a.signed_value < b.signed_value ? -1 : a.signed_value > b.signed_value ? 1 : 0;
+    }
+    // At least one side is unsigned; a negative signed side is below it
+    if (a.kind == Kind::Signed && a.signed_value < 0) {
+        return -1;
+    }
+    if (b.kind == Kind::Signed && b.signed_value < 0) {
+        return 1;
+    }
+    uint64_t x = a.kind == Kind::Signed ? static_cast<uint64_t>(a.signed_value) : a.unsigned_value;
+    uint64_t y = b.kind == Kind::Signed ? static_cast<uint64_t>(b.signed_value) : b.unsigned_value;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/// The Object members of value at fields[i] from segment depth on, nested
+/// as in value; the leaves are shared, not copied. Nothing if none exist.
+std::optional<KvsValue::Object> project(const KvsValue& value, const std::vector<const std::vector<std::string>*>& fields,
+                                        size_t depth) {
+    if (value.getType() != KvsValue::Type::Object) {
+        return std::nullopt;
+    }
+    const auto& object = std::get<KvsValue::Object>(value.getValue());
+    KvsValue::Object result;
+    for (const auto* field : fields) {
+        const std::string& member = (*field)[depth];
+        if (result.count(member) != 0) {
+            continue;
+        }
+        auto child = object.find(member);
+        if (child == object.end() || !child->second) {
+            continue;
+        }
+        // Every field through this member, and whether one ends at it
+        std::vector<const std::vector<std::string>*> below;
+        bool whole = false;
+        for (const auto* other : fields) {
+            if ((*other)[depth] == member) {
+                whole = whole || other->size() == depth + 1;
+                below.push_back(other);
+            }
+        }
+        if (whole) {
+            result.emplace(member, child->second);
+        } else if (auto nested = project(*child->second, below, depth + 1)) {
+            result.emplace(member, std::make_shared<KvsValue>(*nested));
+        }
+    }
+    if (result.empty()) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+} // namespace
+
+Predicate operator&&(Predicate a, Predicate b) {
+    return Predicate([a = std::move(a), b = std::move(b)](const KvsValue& value) { return a(value) && b(value); });
+}
+
+Predicate operator||(Predicate a, Predicate b) {
+    return Predicate([a = std::move(a), b = std::move(b)](const KvsValue& value) { return a(value) || b(value); });
+}
+
+Predicate operator!(Predicate a) {
+    return Predicate([a = std::move(a)](const KvsValue& value) { return !a(value); });
+}
+
+Predicate hasType(KvsValue::Type type) {
+    return Predicate([type](const KvsValue& value) { return value.getType() == type; });
+}
+
+Predicate greaterThan(NumericBound bound) {
+    return Predicate([bound](const KvsValue& value) {
+        auto number = asNumber(value);
+        auto order = number ? compare(*number, bound) : std::nullopt;
+        return order && *order > 0;
+    });
+}
+
+Predicate lessThan(NumericBound bound) {
+    return Predicate([bound](const KvsValue& value) {
+        auto number = asNumber(value);
+        auto order = number ? compare(*number, bound) : std::nullopt;
+        return order && *order < 0;
+    });
+}
+
+Predicate equalTo(const KvsValue& expected) {
+    return Predicate([expected](const KvsValue& value) { return valuesEqual(value, expected); });
+}
+
+Predicate atPath(std::string_view field_path, Predicate predicate) {
+    return Predicate([segments = parsePath(field_path), predicate = std::move(predicate)](const KvsValue& value) {
+        const KvsValue* field = findPath(value, segments, 0);
+        return field != nullptr && predicate(*field);
+    });
+}
+
+ScanView::ScanView(const std::vector<std::string>& field_paths) {
+    for (const auto& path : field_paths) {
+        auto segments = parsePath(path);
+        if (!segments.empty()) {
+            fields.push_back(std::move(segments));
+        }
+    }
+}
+
+std::vector<std::pair<std::string, KvsValue>> ScanView::scan(const Predicate& predicate) const {
+    std::vector<std::pair<std::string, KvsValue>> matches;
+    snapshot().forEach([&](const std::string& key, const ValuePtr& value) {
+        if (predicate(*value)) {
+            matches.emplace_back(key, *value);
+        }
+    });
+    return matches;
+}
+
+PersistentObject ScanView::snapshot() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return values;
+}
+
+void ScanView::on_set(std::string_view key, const KvsValue& value) {
+    if (!fields.empty()) {
+        std::vector<const std::vector<std::string>*> all;
+        for (const auto& field : fields) {
+            all.push_back(&field);
+        }
+        auto projected = project(value, all, 0);
+        std::lock_guard<std::mutex> guard(mutex);
+        if (projected) {
+            values = values.set(std::string(key), std::make_shared<const KvsValue>(*projected));
+        } else {
+            values = values.erase(std::string(key));
+        }
+        return;
+    }
+    auto boxed = std::make_shared<const KvsValue>(value);
+    std::lock_guard<std::mutex> guard(mutex);
+    values = values.set(std::string(key), std::move(boxed));
+}
+
+void ScanView::on_remove(std::string_view key) {
+    std::lock_guard<std::mutex> guard(mutex);
+    values = values.erase(std::string(key));
+}
+
+void ScanView::on_reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    values = PersistentObject();
+}
+
+} // namespace kvs_demo
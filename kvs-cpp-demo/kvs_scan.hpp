@@ -0,0 +1,134 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_scan.hpp
+ * @brief Filtered scans that only copy out matching entries
+ *
+ * Filtering through the Kvs API costs one get_value() copy per key before
+ * the predicate can even look at it. A ScanView listens to a TrackedKvs and
+ * keeps a PersistentObject of the current values, so scan() walks a
+ * snapshot in place and copies only the entries the predicate accepts. The
+ * lock is held just long enough to copy the snapshot's root pointer, so
+ * writers are not blocked for the duration of a scan.
+ *
+ * The view is not free: it holds a second copy of every value it mirrors,
+ * and each write costs a copy of the value into a new box plus O(log n)
+ * trie nodes on the path to the key. Container children are shared with
+ * the written value, but strings and scalars are copied. A view built with
+ * field paths mirrors only those Object members, shares them with the
+ * written value, and skips keys that have none of them, so a store of
+ * large records pays only for the fields its predicates read.
+ *
+ * Predicates compose with &&, || and !, e.g.
+ * hasType(KvsValue::Type::f64) && greaterThan(30.0).
+ */
+
+#ifndef KVS_DEMO_SCAN_HPP
+#define KVS_DEMO_SCAN_HPP
+
+#include "kvs_persistent.hpp"
+#include "kvs_tracked.hpp"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kvs_demo {
+
+class Predicate {
+public:
+    explicit Predicate(std::function<bool(const KvsValue&)> test) : test(std::move(test)) {}
+
+    bool operator()(const KvsValue& value) const { return test(value); }
+
+    friend Predicate operator&&(Predicate a, Predicate b);
+    friend Predicate operator||(Predicate a, Predicate b);
+    friend Predicate operator!(Predicate a);
+
+private:
+    std::function<bool(const KvsValue&)> test;
+};
+
+Predicate hasType(KvsValue::Type type);
+
+/// Bound of a numeric comparison. Integers stay integers, so i64/u64
+/// values beyond 2^53 compare exactly; only comparisons that involve an
+/// f64 on either side go through double.
+class NumericBound {
+public:
+    enum class Kind { Signed, Unsigned, Real };
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    NumericBound(T number) {
+        if constexpr (std::is_floating_point_v<T>) {
+            kind = Kind::Real;
+            real = static_cast<double>(number);
+        } else if constexpr (std::is_signed_v<T>) {
+            kind = Kind::Signed;
+            signed_value = static_cast<int64_t>(number);
+        } else {
+            kind = Kind::Unsigned;
+            unsigned_value = static_cast<uint64_t>(number);
+        }
+    }
+
+    Kind kind;
+    int64_t signed_value = 0;
+    uint64_t unsigned_value = 0;
+    double real = 0;
+};
+
+/// Numeric comparisons; any of the five number types, never other types.
+Predicate greaterThan(NumericBound bound);
+Predicate lessThan(NumericBound bound);
+
+/// Same type and content, as valuesEqual().
+Predicate equalTo(const KvsValue& expected);
+
+/// Apply predicate to the value at field_path (kvs_path.hpp syntax without
+/// the key); false if the field is missing.
+Predicate atPath(std::string_view field_path, Predicate predicate);
+
+class ScanView : public KvsListener {
+public:
+    /// Mirror whole values.
+    ScanView() = default;
+
+    /// Mirror only the Object members at field_paths (atPath() syntax,
+    /// Object members only); predicates must reach them through atPath().
+    explicit ScanView(const std::vector<std::string>& field_paths);
+
+    /// Copies of the matching entries, unordered. A view built with field
+    /// paths returns the mirrored fields only; get the rest by key.
+    std::vector<std::pair<std::string, KvsValue>> scan(const Predicate& predicate) const;
+
+    /// O(1) immutable snapshot of all values.
+    PersistentObject snapshot() const;
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_reset() override;
+
+private:
+    mutable std::mutex mutex;
+    PersistentObject values;
+    std::vector<std::vector<std::string>> fields;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_SCAN_HPP
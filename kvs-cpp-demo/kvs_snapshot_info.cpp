@@ -0,0 +1,80 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_snapshot_info.cpp
+ * @brief Probing and rotating the cached snapshot metadata
+ */
+
+#include "kvs_snapshot_info.hpp"
+#include "kvs_store_file.hpp"
+
+namespace kvs_demo {
+
+SnapshotInfoCache::SnapshotInfoCache(TrackedKvs& tracked, const std::string& dir, InstanceId instance_id)
+    : tracked(tracked),
+      dir(dir),
+      instance_id(instance_id.id),
+      max_count(tracked.kvs().snapshot_max_count()) {
+    appendGenerations(generations, max_count, [this](size_t id) { return probe(id); });
+    tracked.add_listener(*this);
+}
+
+SnapshotInfoCache::~SnapshotInfoCache() {
+    tracked.remove_listener(*this);
+}
+
+size_t SnapshotInfoCache::snapshot_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generations.empty() ? 0 : generations.size() - 1;
+}
+
+std::vector<SnapshotInfo> SnapshotInfoCache::snapshot_info() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generations.empty()) {
+        return {};
+    }
+    return std::vector<SnapshotInfo>(generations.begin() + 1, generations.end());
+}
+
+std::optional<SnapshotInfo> SnapshotInfoCache::current() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generations.empty()) {
+        return std::nullopt;
+    }
+    return generations.front();
+}
+
+void SnapshotInfoCache::on_flush() {
+    auto info = probe(0);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!info) {
+        // Should not happen right after a successful flush; fall back to an empty cache
+        generations.clear();
+        return;
+    }
+    rotateGenerations(generations, *info, max_count);
+    for (size_t id = 0; id < generations.size(); ++id) {
+        generations[id].id = id;
+    }
+}
+
+std::optional<SnapshotInfo> SnapshotInfoCache::probe(size_t id) const {
+    auto file = probeGeneration(dir, instance_id, id);
+    if (!file) {
+        return std::nullopt;
+    }
+    return SnapshotInfo{id, file->json_size, file->checksum, file->written};
+}
+
+} // namespace kvs_demo
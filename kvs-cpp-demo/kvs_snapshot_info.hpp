@@ -0,0 +1,87 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_snapshot_info.hpp
+ * @brief Cached snapshot metadata, kept current by flush
+ *
+ * Kvs::snapshot_count() looks for kvs_<id>_N.json files each time it is
+ * called, so a monitoring loop pays file system calls just to read a
+ * number. SnapshotInfoCache probes the generations once when it is
+ * registered on a TrackedKvs and then follows flushes: a flush rotates
+ * every generation one place up, so only the new current file is looked at.
+ * snapshot_restore() only replaces the in-memory contents; the files, and
+ * so the metadata, change with the next flush.
+ *
+ * All accessors take a mutex and never touch the file system, so they can
+ * be polled from other threads.
+ */
+
+#ifndef KVS_DEMO_SNAPSHOT_INFO_HPP
+#define KVS_DEMO_SNAPSHOT_INFO_HPP
+
+#include "kvs_tracked.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+struct SnapshotInfo {
+    size_t id;                                      ///< 0 is the current store, 1 the newest snapshot
+    uint64_t json_size;
+    uint32_t checksum;                              ///< Adler-32, as in the .hash file
+    std::chrono::system_clock::time_point written;
+};
+
+class SnapshotInfoCache : public KvsListener {
+public:
+    SnapshotInfoCache(TrackedKvs& tracked, const std::string& dir, InstanceId instance_id);
+    ~SnapshotInfoCache() override;
+
+    SnapshotInfoCache(const SnapshotInfoCache&) = delete;
+    SnapshotInfoCache& operator=(const SnapshotInfoCache&) = delete;
+
+    size_t snapshot_count() const;
+    size_t snapshot_max_count() const { return max_count; }
+
+    /// The snapshots, newest (id 1) first.
+    std::vector<SnapshotInfo> snapshot_info() const;
+
+    /// The current store file, or nothing before the first flush.
+    std::optional<SnapshotInfo> current() const;
+
+    void on_set(std::string_view, const KvsValue&) override {}
+    void on_remove(std::string_view) override {}
+    void on_flush() override;
+    void on_reset() override {}
+
+private:
+    std::optional<SnapshotInfo> probe(size_t id) const;
+
+    TrackedKvs& tracked;
+    std::string dir;
+    size_t instance_id;
+    size_t max_count;
+
+    mutable std::mutex mutex;
+    std::vector<SnapshotInfo> generations;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_SNAPSHOT_INFO_HPP
@@ -0,0 +1,143 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_startup.cpp
+ * @brief Work-stealing pool and parallel KvsBuilder::build()
+ */
+
+#include "kvs_startup.hpp"
+#include "kvs_probes.hpp"
+#include "kvs_store_file.hpp"
+#include <algorithm>
+#include <sys/stat.h>
+#include <thread>
+#include <unordered_set>
+
+namespace kvs_demo {
+
+namespace {
+
+/// Size of the instance's current store file; 0 if it does not exist yet.
+size_t storeSize(const std::string& dir, InstanceId instance_id) {
+    struct stat info;
+    std::string path = storePath(dir, instance_id.id, "0.json");
+    return ::stat(path.c_str(), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+}
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t workers)
+    : queues(std::max<size_t>(1, workers != 0 ? workers : std::thread::hardware_concurrency())) {}
+
+WorkStealingPool::Stats WorkStealingPool::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return totals;
+}
+
+void WorkStealingPool::run(std::vector<std::function<void(size_t)>> tasks) {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % queues.size()].tasks.push_back(std::move(tasks[i]));
+    }
+
+    std::vector<std::thread> threads;
+    size_t thread_count = std::min(queues.size(), tasks.size());
+    for (size_t worker = 1; worker < thread_count; ++worker) {
+        threads.emplace_back([this, worker] {
+            std::function<void(size_t)> task;
+            while (takeTask(worker, task)) {
+                task(worker);
+            }
+        });
+    }
+    // The calling thread is worker 0
+    std::function<void(size_t)> task;
+    while (takeTask(0, task)) {
+        task(0);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool WorkStealingPool::takeTask(size_t worker, std::function<void(size_t)>& task) {
+    {
+        WorkerQueue& own = queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            // Dealt largest first, so the front is the largest build left
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            std::lock_guard<std::mutex> stats_lock(stats_mutex);
+            ++totals.executed;
+            return true;
+        }
+    }
+    // The batch is fixed, so once every deque is empty there is nothing left to wait for
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            std::lock_guard<std::mutex> stats_lock(stats_mutex);
+            ++totals.executed;
+            ++totals.stolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<std::vector<InstanceLoad>> buildAll(const std::vector<InstanceId>& instance_ids,
+                                                  const std::string& dir, bool need_kvs, size_t workers) {
+    // Two builds of one instance would race on the same files
+    std::unordered_set<size_t> seen;
+    for (const auto& instance_id : instance_ids) {
+        if (!seen.insert(instance_id.id).second) {
+            return std::nullopt;
+        }
+    }
+
+    std::vector<size_t> order(instance_ids.size());
+    std::vector<size_t> sizes(instance_ids.size());
+    for (size_t i = 0; i < instance_ids.size(); ++i) {
+        order[i] = i;
+        sizes[i] = storeSize(dir, instance_ids[i]);
+    }
+    // Largest first, so the long builds start early and the short ones fill the gaps
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    std::vector<std::optional<InstanceLoad>> slots(instance_ids.size());
+    std::vector<std::function<void(size_t)>> tasks;
+    tasks.reserve(order.size());
+    for (size_t index : order) {
+        tasks.push_back([&, index](size_t worker) {
+            auto start = std::chrono::steady_clock::now();
+            auto result = tracedBuild(instance_ids[index], dir, false, need_kvs);
+            auto load_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            slots[index].emplace(InstanceLoad{instance_ids[index], std::move(result), load_time, worker});
+        });
+    }
+    WorkStealingPool(workers).run(std::move(tasks));
+
+    std::vector<InstanceLoad> loads;
+    loads.reserve(slots.size());
+    for (auto& slot : slots) {
+        loads.push_back(std::move(*slot));
+    }
+    return loads;
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,97 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_startup.hpp
+ * @brief Parallel startup of many KVS instances
+ *
+ * A process with one instance per subsystem spends its startup in
+ * KvsBuilder::build(), once per instance, each reading, hash-checking and
+ * parsing a JSON file. buildAll() runs those builds on a small
+ * work-stealing pool:
+ * - instances are ordered by store file size, largest first, and dealt
+ *   round-robin onto one deque per worker
+ * - a worker pops its own deque from the front, so it starts with its
+ *   largest store, and once it runs dry steals from the front of the
+ *   others, so the largest store left is always the next one to start and
+ *   one large store does not leave the remaining workers idle
+ * - each build is timed; the results come back in the order requested
+ *
+ * Builds of distinct instance ids share no state, so they can run
+ * concurrently; a list naming an instance twice is refused.
+ */
+
+#ifndef KVS_DEMO_STARTUP_HPP
+#define KVS_DEMO_STARTUP_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+/// Runs a fixed batch of tasks to completion on worker threads that steal
+/// from each other when their own deque is empty.
+class WorkStealingPool {
+public:
+    struct Stats {
+        size_t executed = 0;
+        size_t stolen = 0;
+    };
+
+    /// @param workers thread count; 0 picks std::thread::hardware_concurrency()
+    explicit WorkStealingPool(size_t workers = 0);
+
+    /// Deal the tasks round-robin onto the workers and wait for all of them.
+    /// Tasks get the index of the worker that runs them.
+    void run(std::vector<std::function<void(size_t)>> tasks);
+
+    size_t workers() const { return queues.size(); }
+    Stats stats() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void(size_t)>> tasks;
+    };
+
+    bool takeTask(size_t worker, std::function<void(size_t)>& task);
+
+    std::vector<WorkerQueue> queues;
+    mutable std::mutex stats_mutex;
+    Stats totals;
+};
+
+struct InstanceLoad {
+    InstanceId instance_id;
+    score::Result<Kvs> kvs;
+    std::chrono::microseconds load_time;
+    size_t worker;
+};
+
+/// Build every instance in @p instance_ids from @p dir in parallel;
+/// nothing if an id appears more than once.
+std::optional<std::vector<InstanceLoad>> buildAll(const std::vector<InstanceId>& instance_ids, const std::string& dir,
+                                   bool need_kvs = false, size_t workers = 0);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_STARTUP_HPP
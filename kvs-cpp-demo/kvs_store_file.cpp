@@ -0,0 +1,208 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_store_file.cpp
+ * @brief Readers and writers for the two-file and single-file store layouts
+ */
+
+#include "kvs_store_file.hpp"
+#include "kvs_trace.hpp"
+#include "internal/kvs_helper.hpp"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace score::mw::per::kvs;
+
+namespace kvs_demo {
+
+namespace {
+
+const char STORE_FILE_MAGIC[4] = {'K', 'V', 'S', 'F'};
+constexpr uint8_t STORE_FILE_VERSION = 1;
+
+void putBigEndian32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t getBigEndian32(const uint8_t* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+/// Write all buffers to path via path.tmp, then fsync and rename.
+bool writeAtomically(const std::string& path, const void* head, size_t head_size,
+                     const void* body, size_t body_size, SyscallCounter& counter) {
+    std::string tmp_path = path + ".tmp";
+    TraceSpan write_span("write_file", "io");
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    ++counter.opens;
+    if (fd < 0) {
+        return false;
+    }
+
+    // Header and payload go out in a single gathered write
+    struct iovec parts[2];
+    int part_count = 0;
+    if (head_size > 0) {
+        parts[part_count++] = {const_cast<void*>(head), head_size};
+    }
+    if (body_size > 0) {
+        parts[part_count++] = {const_cast<void*>(body), body_size};
+    }
+    bool ok = ::writev(fd, parts, part_count) == static_cast<ssize_t>(head_size + body_size);
+    ++counter.writes;
+    if (ok) {
+        TraceSpan sync_span("fsync", "io");
+        ok = ::fsync(fd) == 0;
+        ++counter.syncs;
+    }
+    ::close(fd);
+    ++counter.closes;
+
+    if (ok) {
+        TraceSpan rename_span("rename", "io");
+        ok = ::rename(tmp_path.c_str(), path.c_str()) == 0;
+        ++counter.renames;
+    }
+    if (!ok) {
+        ::unlink(tmp_path.c_str());
+    }
+    return ok;
+}
+
+std::optional<std::string> readWholeFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string hashPathFor(const std::string& json_path) {
+    const std::string extension = ".json";
+    if (json_path.size() >= extension.size() &&
+        json_path.compare(json_path.size() - extension.size(), extension.size(), extension) == 0) {
+        return json_path.substr(0, json_path.size() - extension.size()) + ".hash";
+    }
+    return json_path + ".hash";
+}
+
+} // namespace
+
+bool writeFileAtomically(const std::string& path, const void* data, size_t size, SyscallCounter& counter) {
+    return writeAtomically(path, nullptr, 0, data, size, counter);
+}
+
+bool writeFileAtomically(const std::string& path, const std::string& data, SyscallCounter& counter) {
+    return writeAtomically(path, nullptr, 0, data.data(), data.size(), counter);
+}
+
+bool writeStoreFilePair(const std::string& json_path, const std::string& json, SyscallCounter& counter) {
+    if (!writeFileAtomically(json_path, json, counter)) {
+        return false;
+    }
+    std::array<uint8_t, 4> hash_bytes;
+    {
+        TraceSpan span("hash", "kvs");
+        hash_bytes = get_hash_bytes_adler32(calculate_hash_adler32(json));
+    }
+    return writeFileAtomically(hashPathFor(json_path), hash_bytes.data(), hash_bytes.size(), counter);
+}
+
+bool writeStoreFile(const std::string& path, const std::string& json, SyscallCounter& counter) {
+    if (json.size() > UINT32_MAX) {
+        return false;
+    }
+
+    uint8_t header[STORE_FILE_HEADER_SIZE] = {};
+    std::memcpy(header, STORE_FILE_MAGIC, sizeof(STORE_FILE_MAGIC));
+    header[4] = STORE_FILE_VERSION;
+    {
+        TraceSpan span("hash", "kvs");
+        putBigEndian32(header + 8, calculate_hash_adler32(json));
+    }
+    putBigEndian32(header + 12, static_cast<uint32_t>(json.size()));
+    return writeAtomically(path, header, sizeof(header), json.data(), json.size(), counter);
+}
+
+std::optional<std::string> readStoreFile(const std::string& path) {
+    auto content = readWholeFile(path);
+    if (!content) {
+        return std::nullopt;
+    }
+
+    if (content->size() >= STORE_FILE_HEADER_SIZE &&
+        std::memcmp(content->data(), STORE_FILE_MAGIC, sizeof(STORE_FILE_MAGIC)) == 0) {
+        const auto* header = reinterpret_cast<const uint8_t*>(content->data());
+        if (header[4] != STORE_FILE_VERSION) {
+            return std::nullopt;
+        }
+        uint32_t expected_hash = getBigEndian32(header + 8);
+        uint32_t length = getBigEndian32(header + 12);
+        if (content->size() - STORE_FILE_HEADER_SIZE != length) {
+            return std::nullopt;
+        }
+        std::string json = content->substr(STORE_FILE_HEADER_SIZE);
+        if (calculate_hash_adler32(json) != expected_hash) {
+            return std::nullopt;
+        }
+        return json;
+    }
+
+    // Legacy two-file layout: checksum lives in the .hash sibling
+    auto hash = readWholeFile(hashPathFor(path));
+    if (!hash || hash->size() != 4) {
+        return std::nullopt;
+    }
+    if (calculate_hash_adler32(*content) != getBigEndian32(reinterpret_cast<const uint8_t*>(hash->data()))) {
+        return std::nullopt;
+    }
+    return content;
+}
+
+std::string storePath(const std::string& dir, size_t instance_id, std::string_view suffix) {
+    std::string path = dir + "/kvs_" + std::to_string(instance_id) + "_";
+    path.append(suffix);
+    return path;
+}
+
+std::string generationPath(const std::string& dir, size_t instance_id, size_t generation) {
+    return storePath(dir, instance_id, std::to_string(generation));
+}
+
+std::optional<GenerationFile> probeGeneration(const std::string& dir, size_t instance_id, size_t generation) {
+    std::string prefix = generationPath(dir, instance_id, generation);
+    struct stat info;
+    std::ifstream hash_file(prefix + ".hash", std::ios::binary);
+    uint8_t hash[4];
+    if (::stat((prefix + ".json").c_str(), &info) != 0 ||
+        !hash_file.read(reinterpret_cast<char*>(hash), sizeof(hash))) {
+        return std::nullopt;
+    }
+    auto written = std::chrono::system_clock::from_time_t(info.st_mtim.tv_sec) +
+                   std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                       std::chrono::nanoseconds(info.st_mtim.tv_nsec));
+    return GenerationFile{static_cast<uint64_t>(info.st_size), getBigEndian32(hash), written};
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,121 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_store_file.hpp
+ * @brief Single-file store format with an embedded Adler-32 checksum
+ *
+ * The persistency library stores every generation as a pair of files,
+ * kvs_<id>_N.json plus kvs_<id>_N.hash. The single-file format keeps the
+ * same JSON payload and the same Adler-32 checksum, but puts the checksum
+ * in a 16-byte header in front of the payload:
+ *
+ *   offset  size  field
+ *   0       4     magic "KVSF"
+ *   4       1     format version (1)
+ *   5       3     reserved, zero
+ *   8       4     Adler-32 of the payload, big-endian (as in .hash files)
+ *   12      4     payload length in bytes, big-endian
+ *   16      n     JSON payload
+ *
+ * readStoreFile() accepts both layouts, so existing two-file stores stay
+ * readable. storePath() builds the library's file names, and the
+ * generation helpers below probe and rotate kvs_<id>_N the way the library
+ * counts and shifts them, for the caches that mirror that metadata.
+ */
+
+#ifndef KVS_DEMO_STORE_FILE_HPP
+#define KVS_DEMO_STORE_FILE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kvs_demo {
+
+constexpr size_t STORE_FILE_HEADER_SIZE = 16;
+
+/// Counts the file system calls issued by the writers below.
+struct SyscallCounter {
+    size_t opens = 0;
+    size_t writes = 0;
+    size_t syncs = 0;
+    size_t renames = 0;
+    size_t closes = 0;
+
+    size_t total() const { return opens + writes + syncs + renames + closes; }
+};
+
+/// Write data to path via path.tmp, synced and renamed into place.
+bool writeFileAtomically(const std::string& path, const void* data, size_t size, SyscallCounter& counter);
+bool writeFileAtomically(const std::string& path, const std::string& data, SyscallCounter& counter);
+
+/// Write json_path and its sibling .hash file the way the library does,
+/// each through a temporary file that is synced and renamed into place.
+bool writeStoreFilePair(const std::string& json_path, const std::string& json, SyscallCounter& counter);
+
+/// Write the single-file layout through a temporary file, synced and renamed.
+bool writeStoreFile(const std::string& path, const std::string& json, SyscallCounter& counter);
+
+/// Read and verify a store file in either layout. For the two-file layout
+/// path names the .json file and the checksum comes from the .hash sibling.
+/// Returns the JSON payload, or nothing if the file is missing or corrupted.
+std::optional<std::string> readStoreFile(const std::string& path);
+
+/// dir/kvs_<instance_id>_<suffix>, e.g. storePath(dir, 3, "0.json").
+std::string storePath(const std::string& dir, size_t instance_id, std::string_view suffix);
+
+/// dir/kvs_<instance_id>_<generation>, without the .json or .hash extension.
+std::string generationPath(const std::string& dir, size_t instance_id, size_t generation);
+
+/// What stat() and the .hash file say about one generation.
+struct GenerationFile {
+    uint64_t json_size;
+    uint32_t checksum;                              ///< Adler-32, as in the .hash file
+    std::chrono::system_clock::time_point written;
+};
+
+/// Nothing if the .json file or a 4-byte .hash file is missing.
+std::optional<GenerationFile> probeGeneration(const std::string& dir, size_t instance_id, size_t generation);
+
+/// Append generations generations.size() .. max_count from probe(n), which
+/// returns an optional, stopping at the first missing one as the library does.
+template <typename T, typename Probe>
+void appendGenerations(std::vector<T>& generations, size_t max_count, Probe probe) {
+    while (generations.size() <= max_count) {
+        auto next = probe(generations.size());
+        if (!next) {
+            break;
+        }
+        generations.push_back(std::move(*next));
+    }
+}
+
+/// Follow a flush: current becomes generation 0, the others move one place
+/// up, and whatever falls past max_count snapshots is dropped.
+template <typename T>
+void rotateGenerations(std::vector<T>& generations, T current, size_t max_count) {
+    generations.insert(generations.begin(), std::move(current));
+    if (generations.size() > max_count + 1) {
+        generations.resize(max_count + 1);
+    }
+}
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_STORE_FILE_HPP
@@ -0,0 +1,173 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_subscribe.cpp
+ * @brief Dispatcher thread for change subscriptions
+ */
+
+#include "kvs_subscribe.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace kvs_demo {
+
+namespace {
+
+// Upper bound on delivery latency if a wakeup races with the dispatcher
+// going to sleep; writers never take the dispatcher's lock
+constexpr std::chrono::milliseconds IDLE_POLL(10);
+
+} // namespace
+
+SubscriptionHub::SubscriptionHub() : dispatcher(&SubscriptionHub::dispatchLoop, this) {}
+
+SubscriptionHub::~SubscriptionHub() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    dispatcher.join();
+}
+
+SubscriptionHub::SubscriptionId SubscriptionHub::subscribe(std::string_view key_or_prefix, Callback callback) {
+    Subscription subscription{0, std::string(key_or_prefix), false, std::move(callback)};
+    if (!subscription.pattern.empty() && subscription.pattern.back() == '*') {
+        subscription.pattern.pop_back();
+        subscription.prefix = true;
+    }
+
+    std::lock_guard<std::mutex> lock(subscriptions_mutex);
+    subscription.id = next_id++;
+    subscriptions.push_back(std::move(subscription));
+    return subscriptions.back().id;
+}
+
+void SubscriptionHub::unsubscribe(SubscriptionId id) {
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex);
+        subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                           [id](const Subscription& s) { return s.id == id; }),
+                            subscriptions.end());
+    }
+    // Later batches no longer see it; wait out the one in flight, unless that is our caller
+    if (std::this_thread::get_id() != dispatcher.get_id()) {
+        std::lock_guard<std::mutex> delivery(delivery_mutex);
+    }
+}
+
+bool SubscriptionHub::wait_delivered(std::chrono::milliseconds timeout) {
+    uint64_t target = commits_published.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex);
+    return delivered.wait_for(lock, timeout, [this, target] { return commits_delivered >= target; });
+}
+
+void SubscriptionHub::on_set(std::string_view key, const KvsValue& value) {
+    publish(Event{Change{Change::Kind::Set, std::string(key), value}});
+}
+
+void SubscriptionHub::on_remove(std::string_view key) {
+    publish(Event{Change{Change::Kind::Remove, std::string(key), std::nullopt}});
+}
+
+void SubscriptionHub::on_flush() {
+    commits_published.fetch_add(1, std::memory_order_acq_rel);
+    publish(Event{Change{}, true});
+    wakeup.notify_one();
+}
+
+void SubscriptionHub::on_reset() {
+    publish(Event{Change{Change::Kind::Reset, std::string(), std::nullopt}});
+}
+
+void SubscriptionHub::publish(Event event) {
+    queue.push(std::move(event));
+}
+
+void SubscriptionHub::dispatchLoop() {
+    std::vector<Change> pending;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        lock.unlock();
+        uint64_t commits = 0;
+        while (auto event = queue.pop()) {
+            if (!event->commit) {
+                pending.push_back(std::move(event->change));
+                continue;
+            }
+            deliver(pending);
+            pending.clear();
+            ++commits;
+        }
+        lock.lock();
+
+        if (commits > 0) {
+            commits_delivered += commits;
+            delivered.notify_all();
+        }
+        if (stopping) {
+            // Uncommitted changes are dropped, as they would be on disk
+            return;
+        }
+        wakeup.wait_for(lock, IDLE_POLL);
+    }
+}
+
+void SubscriptionHub::deliver(std::vector<Change>& batch) {
+    // Keep only the last change per key; a reset supersedes everything before it
+    std::vector<Change> coalesced;
+    std::unordered_map<std::string, size_t> position;
+    for (auto& change : batch) {
+        if (change.kind == Change::Kind::Reset) {
+            coalesced.clear();
+            position.clear();
+            coalesced.push_back(std::move(change));
+            continue;
+        }
+        auto found = position.find(change.key);
+        if (found != position.end()) {
+            coalesced[found->second].kind = change.kind;
+            coalesced[found->second].value = std::move(change.value);
+        } else {
+            position.emplace(change.key, coalesced.size());
+            coalesced.push_back(std::move(change));
+        }
+    }
+    if (coalesced.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> delivery(delivery_mutex);
+    std::vector<Subscription> targets;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex);
+        targets = subscriptions;
+    }
+    for (const auto& subscription : targets) {
+        std::vector<Change> matches;
+        for (const auto& change : coalesced) {
+            bool match = change.kind == Change::Kind::Reset ||
+                         (subscription.prefix ? change.key.compare(0, subscription.pattern.size(), subscription.pattern) == 0
+                                              : change.key == subscription.pattern);
+            if (match) {
+                matches.push_back(change);
+            }
+        }
+        if (!matches.empty()) {
+            subscription.callback(matches);
+        }
+    }
+}
+
+} // namespace kvs_demo
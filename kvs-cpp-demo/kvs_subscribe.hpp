@@ -0,0 +1,179 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_subscribe.hpp
+ * @brief Change subscriptions for keys and key prefixes
+ *
+ * A SubscriptionHub listens to a TrackedKvs. Writers only push the change
+ * onto a lock-free multi-producer queue, so a slow subscriber can never
+ * hold up set_value(). A dispatcher thread drains the queue and, at each
+ * successful flush, delivers the changes committed by it in one batch per
+ * subscription: coalesced to the last change per key, in commit order, on
+ * the dispatcher thread.
+ *
+ * Subscribing to "status" matches that key only; a pattern with a trailing
+ * '*' matches every key that starts with the part before it.
+ *
+ * Register the hub with add_listener(hub, false): keys already in the store
+ * are not changes, and replaying them would deliver every one of them at
+ * the next flush. reset() and snapshot_restore() only report the new
+ * contents, so after either one the next flush delivers a Reset followed
+ * by a Set for every key present afterwards, changed or not.
+ */
+
+#ifndef KVS_DEMO_SUBSCRIBE_HPP
+#define KVS_DEMO_SUBSCRIBE_HPP
+
+#include "kvs_tracked.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kvs_demo {
+
+/// Unbounded multi-producer, single-consumer queue (Vyukov). push() is
+/// wait-free apart from the allocation; pop() may only be called from one
+/// thread at a time.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node), tail(head.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        while (tail != nullptr) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    std::optional<T> pop() {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+        std::optional<T> value = std::move(next->value);
+        next->value.reset();
+        delete tail;
+        tail = next;
+        return value;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    std::atomic<Node*> head;
+    Node* tail;
+};
+
+struct Change {
+    enum class Kind {
+        Set,
+        Remove,
+        Reset,
+    };
+
+    Kind kind;
+    std::string key;
+    // Only set for Kind::Set
+    std::optional<KvsValue> value;
+};
+
+class SubscriptionHub : public KvsListener {
+public:
+    using Callback = std::function<void(const std::vector<Change>&)>;
+    using SubscriptionId = uint64_t;
+
+    SubscriptionHub();
+    ~SubscriptionHub() override;
+
+    SubscriptionHub(const SubscriptionHub&) = delete;
+    SubscriptionHub& operator=(const SubscriptionHub&) = delete;
+
+    /// Deliver committed changes of a key, or of a prefix ending in '*'.
+    /// A reset is delivered to every subscription.
+    SubscriptionId subscribe(std::string_view key_or_prefix, Callback callback);
+
+    /// Remove a subscription. Once this returns its callback is not running
+    /// and will not be called again, so its state may be destroyed. Called
+    /// from a callback it cannot wait for the batch that is running it.
+    void unsubscribe(SubscriptionId id);
+
+    /// Wait until every commit so far has been delivered.
+    bool wait_delivered(std::chrono::milliseconds timeout);
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_flush() override;
+    void on_reset() override;
+
+private:
+    struct Event {
+        Change change;
+        bool commit = false;
+    };
+
+    struct Subscription {
+        SubscriptionId id;
+        std::string pattern;
+        bool prefix;
+        Callback callback;
+    };
+
+    void publish(Event event);
+    void dispatchLoop();
+    void deliver(std::vector<Change>& batch);
+
+    MpscQueue<Event> queue;
+
+    std::mutex subscriptions_mutex;
+    std::vector<Subscription> subscriptions;
+    // Held by the dispatcher while it runs callbacks
+    std::mutex delivery_mutex;
+    SubscriptionId next_id = 1;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable delivered;
+    std::atomic<uint64_t> commits_published{0};
+    uint64_t commits_delivered = 0;
+    bool stopping = false;
+    std::thread dispatcher;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_SUBSCRIBE_HPP
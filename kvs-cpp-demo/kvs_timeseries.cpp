@@ -0,0 +1,349 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_timeseries.cpp
+ * @brief Delta-of-delta and XOR encoding for TimeSeries blocks
+ *
+ * Serialized layout, integers little-endian:
+ *   "KVTS", u32 capacity, u32 block size, u32 block count, then per block
+ *   u32 sample count, u32 bit count, ceil(bit count / 8) bytes of bits.
+ */
+
+#include "kvs_timeseries.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace kvs_demo {
+
+namespace {
+
+const char TIMESERIES_MAGIC[4] = {'K', 'V', 'T', 'S'};
+
+// Delta-of-delta buckets: control bits, control length, payload bits
+struct Bucket {
+    uint64_t control;
+    unsigned control_bits;
+    unsigned value_bits;
+};
+const Bucket TIMESTAMP_BUCKETS[] = {
+    {0b10, 2, 7},
+    {0b110, 3, 9},
+    {0b1110, 4, 12},
+    {0b1111, 4, 64},
+};
+
+unsigned countLeadingZeros(uint64_t value) {
+    return value == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(value));
+}
+
+unsigned countTrailingZeros(uint64_t value) {
+    return value == 0 ? 64 : static_cast<unsigned>(__builtin_ctzll(value));
+}
+
+int64_t wrappingAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+int64_t wrappingSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+class BitReader {
+public:
+    BitReader(const std::vector<uint8_t>& bits, size_t bit_count) : bits(bits), bit_count(bit_count) {}
+
+    bool read(unsigned count, uint64_t& value) {
+        if (bit_count - position < count) {
+            return false;
+        }
+        value = 0;
+        for (unsigned i = 0; i < count; ++i, ++position) {
+            value = (value << 1) | ((bits[position / 8] >> (7 - position % 8)) & 1u);
+        }
+        return true;
+    }
+
+private:
+    const std::vector<uint8_t>& bits;
+    size_t bit_count;
+    size_t position = 0;
+};
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+bool getU32(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+    if (end - data < 4) {
+        return false;
+    }
+    value = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    data += 4;
+    return true;
+}
+
+} // namespace
+
+void TimeSeries::Block::writeBits(uint64_t value, unsigned count) {
+    for (unsigned i = count; i-- > 0;) {
+        if (bit_count % 8 == 0) {
+            bits.push_back(0);
+        }
+        if ((value >> i) & 1u) {
+            bits.back() |= static_cast<uint8_t>(0x80u >> (bit_count % 8));
+        }
+        ++bit_count;
+    }
+}
+
+void TimeSeries::Block::encode(int64_t timestamp, double value) {
+    uint64_t value_bits = toBits(value);
+
+    if (sample_count == 0) {
+        writeBits(static_cast<uint64_t>(timestamp), 64);
+        writeBits(value_bits, 64);
+    } else {
+        // Wrapping arithmetic: any int64 timestamp sequence round-trips
+        int64_t delta = wrappingSub(timestamp, previous_timestamp);
+        int64_t delta_of_delta = wrappingSub(delta, previous_delta);
+        previous_delta = delta;
+
+        if (delta_of_delta == 0) {
+            writeBits(0, 1);
+        } else {
+            for (const auto& bucket : TIMESTAMP_BUCKETS) {
+                int64_t limit = bucket.value_bits == 64 ? 0 : (int64_t{1} << (bucket.value_bits - 1));
+                if (bucket.value_bits == 64 || (delta_of_delta >= -limit && delta_of_delta < limit)) {
+                    writeBits(bucket.control, bucket.control_bits);
+                    writeBits(static_cast<uint64_t>(delta_of_delta), bucket.value_bits);
+                    break;
+                }
+            }
+        }
+
+        uint64_t xored = value_bits ^ previous_value;
+        if (xored == 0) {
+            writeBits(0, 1);
+        } else {
+            unsigned leading = countLeadingZeros(xored);
+            unsigned trailing = countTrailingZeros(xored);
+            // Five bits for the leading zero count, as in the paper
+            if (leading > 31) {
+                leading = 31;
+            }
+            if (previous_leading != 0xff && leading >= previous_leading && trailing >= previous_trailing) {
+                writeBits(0b10, 2);
+                writeBits(xored >> previous_trailing, 64 - previous_leading - previous_trailing);
+            } else {
+                unsigned meaningful = 64 - leading - trailing;
+                writeBits(0b11, 2);
+                writeBits(leading, 5);
+                writeBits(meaningful - 1, 6);
+                writeBits(xored >> trailing, meaningful);
+                previous_leading = leading;
+                previous_trailing = trailing;
+            }
+        }
+    }
+
+    previous_timestamp = timestamp;
+    previous_value = value_bits;
+    ++sample_count;
+}
+
+TimeSeries::TimeSeries(size_t capacity, size_t block_size)
+    : max_samples(capacity), block_size(std::max<size_t>(1, std::min(block_size, capacity))) {}
+
+void TimeSeries::append(int64_t timestamp, double value) {
+    if (blocks.empty() || blocks.back().sealed || blocks.back().sample_count >= block_size) {
+        blocks.emplace_back();
+    }
+    blocks.back().encode(timestamp, value);
+    ++sample_count;
+
+    while (sample_count > max_samples && blocks.size() > 1) {
+        sample_count -= blocks.front().sample_count;
+        blocks.pop_front();
+    }
+}
+
+bool TimeSeries::decodeBlock(const Block& block, std::vector<Sample>& out) {
+    BitReader reader(block.bits, block.bit_count);
+    uint64_t timestamp_bits = 0;
+    uint64_t value_bits = 0;
+    if (block.sample_count == 0) {
+        return true;
+    }
+    if (!reader.read(64, timestamp_bits) || !reader.read(64, value_bits)) {
+        return false;
+    }
+
+    int64_t timestamp = static_cast<int64_t>(timestamp_bits);
+    int64_t delta = 0;
+    unsigned leading = 0;
+    unsigned trailing = 0;
+    out.push_back({timestamp, fromBits(value_bits)});
+
+    for (uint32_t i = 1; i < block.sample_count; ++i) {
+        uint64_t bit = 0;
+        if (!reader.read(1, bit)) {
+            return false;
+        }
+        if (bit != 0) {
+            // Count the control bits to find the bucket
+            unsigned ones = 1;
+            while (ones < 4) {
+                if (!reader.read(1, bit)) {
+                    return false;
+                }
+                if (bit == 0) {
+                    break;
+                }
+                ++ones;
+            }
+            const Bucket& bucket = TIMESTAMP_BUCKETS[ones - 1];
+            uint64_t raw = 0;
+            if (!reader.read(bucket.value_bits, raw)) {
+                return false;
+            }
+            int64_t delta_of_delta = static_cast<int64_t>(raw);
+            if (bucket.value_bits < 64 && (raw >> (bucket.value_bits - 1)) != 0) {
+                delta_of_delta -= int64_t{1} << bucket.value_bits;
+            }
+            delta = wrappingAdd(delta, delta_of_delta);
+        }
+        timestamp = wrappingAdd(timestamp, delta);
+
+        if (!reader.read(1, bit)) {
+            return false;
+        }
+        if (bit != 0) {
+            if (!reader.read(1, bit)) {
+                return false;
+            }
+            if (bit != 0) {
+                uint64_t leading_bits = 0;
+                uint64_t meaningful_bits = 0;
+                if (!reader.read(5, leading_bits) || !reader.read(6, meaningful_bits)) {
+                    return false;
+                }
+                // The encoder never writes a window wider than 64 bits
+                if (leading_bits + meaningful_bits + 1 > 64) {
+                    return false;
+                }
+                leading = static_cast<unsigned>(leading_bits);
+                trailing = 64 - leading - static_cast<unsigned>(meaningful_bits + 1);
+            }
+            uint64_t meaningful = 0;
+            if (!reader.read(64 - leading - trailing, meaningful)) {
+                return false;
+            }
+            value_bits ^= meaningful << trailing;
+        }
+        out.push_back({timestamp, fromBits(value_bits)});
+    }
+    return true;
+}
+
+std::optional<std::vector<TimeSeries::Sample>> TimeSeries::samples() const {
+    std::vector<Sample> out;
+    out.reserve(sample_count);
+    for (const auto& block : blocks) {
+        if (!decodeBlock(block, out)) {
+            return std::nullopt;
+        }
+    }
+    return out;
+}
+
+size_t TimeSeries::compressedBytes() const {
+    size_t bytes = 0;
+    for (const auto& block : blocks) {
+        bytes += block.bits.size();
+    }
+    return bytes;
+}
+
+std::string TimeSeries::serialize() const {
+    std::string out(TIMESERIES_MAGIC, sizeof(TIMESERIES_MAGIC));
+    putU32(out, static_cast<uint32_t>(max_samples));
+    putU32(out, static_cast<uint32_t>(block_size));
+    putU32(out, static_cast<uint32_t>(blocks.size()));
+    for (const auto& block : blocks) {
+        putU32(out, block.sample_count);
+        putU32(out, static_cast<uint32_t>(block.bit_count));
+        out.append(reinterpret_cast<const char*>(block.bits.data()), block.bits.size());
+    }
+    return out;
+}
+
+std::optional<TimeSeries> TimeSeries::deserialize(const uint8_t* data, size_t size) {
+    const uint8_t* end = data + size;
+    if (size < sizeof(TIMESERIES_MAGIC) || std::memcmp(data, TIMESERIES_MAGIC, sizeof(TIMESERIES_MAGIC)) != 0) {
+        return std::nullopt;
+    }
+    data += sizeof(TIMESERIES_MAGIC);
+
+    uint32_t capacity = 0;
+    uint32_t block_size = 0;
+    uint32_t block_count = 0;
+    if (!getU32(data, end, capacity) || !getU32(data, end, block_size) || !getU32(data, end, block_count)) {
+        return std::nullopt;
+    }
+
+    TimeSeries series(capacity, block_size);
+    for (uint32_t i = 0; i < block_count; ++i) {
+        Block block;
+        uint32_t bit_count = 0;
+        if (!getU32(data, end, block.sample_count) || !getU32(data, end, bit_count)) {
+            return std::nullopt;
+        }
+        size_t byte_count = (static_cast<size_t>(bit_count) + 7) / 8;
+        if (static_cast<size_t>(end - data) < byte_count || block.sample_count > series.block_size) {
+            return std::nullopt;
+        }
+        block.bits.assign(data, data + byte_count);
+        block.bit_count = bit_count;
+        data += byte_count;
+        series.sample_count += block.sample_count;
+        series.blocks.push_back(std::move(block));
+    }
+    if (series.sample_count > series.max_samples && series.blocks.size() > 1) {
+        return std::nullopt;
+    }
+
+    // The encoder state of the open block is not serialized; appends after a
+    // reload start a fresh block so the stored bits stay valid.
+    if (!series.blocks.empty()) {
+        series.blocks.back().sealed = true;
+    }
+    return series;
+}
+
+} // namespace kvs_demo
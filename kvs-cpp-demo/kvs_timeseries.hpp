@@ -0,0 +1,98 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_timeseries.hpp
+ * @brief Fixed-capacity time series with Gorilla-style compression
+ *
+ * Samples are compressed as they are appended, into blocks of block_size
+ * samples. Each block starts with a raw timestamp and value; after that,
+ * timestamps are stored as delta-of-delta in variable-width buckets and
+ * values as the XOR with the previous value, reusing the previous window of
+ * meaningful bits when possible (Pelkonen et al., "Gorilla", VLDB 2015).
+ *
+ * append() is O(1): it only writes bits to the open block. When the series
+ * holds more than capacity samples the oldest block is dropped whole, so the
+ * series keeps between capacity - block_size + 1 and capacity samples. The
+ * block size is clamped to the capacity.
+ *
+ * serialize() concatenates the blocks as they are, so persisting the history
+ * costs no re-encoding; it is meant to be stored as a byte value (see
+ * BlobStore::set_bytes()).
+ */
+
+#ifndef KVS_DEMO_TIMESERIES_HPP
+#define KVS_DEMO_TIMESERIES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+class TimeSeries {
+public:
+    struct Sample {
+        int64_t timestamp;
+        double value;
+    };
+
+    explicit TimeSeries(size_t capacity, size_t block_size = 128);
+
+    void append(int64_t timestamp, double value);
+
+    /// Decode every retained sample, oldest first; nothing if a block is
+    /// malformed (possible only for a deserialized series).
+    std::optional<std::vector<Sample>> samples() const;
+
+    size_t size() const { return sample_count; }
+    size_t capacity() const { return max_samples; }
+
+    /// Compressed payload size in bytes, without the serialization header.
+    size_t compressedBytes() const;
+
+    std::string serialize() const;
+    static std::optional<TimeSeries> deserialize(const uint8_t* data, size_t size);
+
+private:
+    struct Block {
+        std::vector<uint8_t> bits;
+        size_t bit_count = 0;
+        uint32_t sample_count = 0;
+        bool sealed = false;
+
+        // Encoder state, only meaningful for the open block
+        int64_t previous_timestamp = 0;
+        int64_t previous_delta = 0;
+        uint64_t previous_value = 0;
+        unsigned previous_leading = 0xff;
+        unsigned previous_trailing = 0;
+
+        void writeBits(uint64_t value, unsigned count);
+        void encode(int64_t timestamp, double value);
+    };
+
+    static bool decodeBlock(const Block& block, std::vector<Sample>& out);
+
+    size_t max_samples;
+    size_t block_size;
+    size_t sample_count = 0;
+    std::deque<Block> blocks;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_TIMESERIES_HPP
@@ -0,0 +1,117 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_trace.cpp
+ * @brief Ring buffer recording and Chrome trace-event JSON export
+ */
+
+#include "kvs_trace.hpp"
+#include "kvs_store_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+namespace kvs_demo {
+
+namespace {
+
+/// Small per-thread id for the "tid" field, in order of first use.
+uint32_t traceThreadId() {
+    static std::atomic<uint32_t> next_thread{1};
+    thread_local uint32_t id = next_thread.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int64_t instance;
+    uint32_t thread;
+};
+
+} // namespace
+
+std::atomic<TraceSink*> TraceSink::current{nullptr};
+
+TraceSink::TraceSink(size_t capacity)
+    : slot_count(std::max<size_t>(1, capacity)), slots(new Slot[slot_count]), origin(Clock::now()) {}
+
+void TraceSink::install(TraceSink* sink) {
+    current.store(sink, std::memory_order_release);
+}
+
+void TraceSink::record(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                       int64_t instance) {
+    uint64_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket % slot_count];
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count(),
+                        std::memory_order_relaxed);
+    slot.duration_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                           std::memory_order_relaxed);
+    slot.instance.store(instance, std::memory_order_relaxed);
+    slot.thread.store(traceThreadId(), std::memory_order_relaxed);
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+bool TraceSink::dump(const std::string& path) const {
+    std::vector<Event> events;
+    events.reserve(slot_count);
+    for (size_t i = 0; i < slot_count; ++i) {
+        const Slot& slot = slots[i];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || before % 2 != 0) {
+            continue;
+        }
+        Event event{slot.name.load(std::memory_order_relaxed), slot.category.load(std::memory_order_relaxed),
+                    slot.start_ns.load(std::memory_order_relaxed), slot.duration_ns.load(std::memory_order_relaxed),
+                    slot.instance.load(std::memory_order_relaxed), slot.thread.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            events.push_back(event);
+        }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const Event& a, const Event& b) { return a.start_ns < b.start_ns; });
+
+    // Names are literals from this code base, so they need no JSON escaping
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char buffer[256];
+    int pid = static_cast<int>(::getpid());
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        int length = std::snprintf(buffer, sizeof(buffer),
+                                   "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                                   "\"pid\":%d,\"tid\":%u",
+                                   i == 0 ? "" : ",", event.name, event.category, event.start_ns / 1000.0,
+                                   event.duration_ns / 1000.0, pid, event.thread);
+        json.append(buffer, static_cast<size_t>(std::min<int>(length, sizeof(buffer) - 1)));
+        if (event.instance >= 0) {
+            json += ",\"args\":{\"instance\":" + std::to_string(event.instance) + "}";
+        }
+        json += "}";
+    }
+    json += "\n]}\n";
+
+    SyscallCounter counter;
+    return writeFileAtomically(path, json, counter);
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,117 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_trace.hpp
+ * @brief Span recording into a ring buffer, exported as Chrome trace events
+ *
+ * TraceSpan marks a scope (build, flush, and the hash/write/fsync/rename
+ * steps of the demo's own writers). While a TraceSink is installed, every
+ * span ends up in its fixed-size ring buffer; without one, a span costs a
+ * single atomic load. Recording never blocks: writers claim a slot with one
+ * fetch_add and the oldest spans are overwritten once the ring is full.
+ *
+ * dump() writes the buffered spans as Chrome trace-event JSON ("X" events
+ * with microsecond timestamps), which chrome://tracing and
+ * https://ui.perfetto.dev open directly. It may run while spans are being
+ * recorded; slots caught mid-write are skipped.
+ *
+ * Span names and categories must be string literals. Uninstall a sink and
+ * let in-flight operations finish before destroying it.
+ */
+
+#ifndef KVS_DEMO_TRACE_HPP
+#define KVS_DEMO_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace kvs_demo {
+
+class TraceSink {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TraceSink(size_t capacity = 65536);
+
+    TraceSink(const TraceSink&) = delete;
+    TraceSink& operator=(const TraceSink&) = delete;
+
+    /// Make sink the target of all TraceSpans; nullptr stops recording.
+    static void install(TraceSink* sink);
+    static TraceSink* installed() { return current.load(std::memory_order_acquire); }
+
+    void record(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                int64_t instance);
+
+    /// Write the buffered spans as Chrome trace-event JSON.
+    bool dump(const std::string& path) const;
+
+    /// Spans recorded so far, including those already overwritten.
+    uint64_t recorded() const { return next.load(std::memory_order_relaxed); }
+    size_t capacity() const { return slot_count; }
+
+private:
+    // Seqlock per slot: odd while being written, 2 * ticket + 2 once complete
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<const char*> category{nullptr};
+        std::atomic<int64_t> start_ns{0};
+        std::atomic<int64_t> duration_ns{0};
+        std::atomic<int64_t> instance{-1};
+        std::atomic<uint32_t> thread{0};
+    };
+
+    size_t slot_count;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> next{0};
+    Clock::time_point origin;
+
+    static std::atomic<TraceSink*> current;
+};
+
+/// Records the enclosing scope as a span in the installed sink, if any.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "kvs", int64_t instance = -1)
+        : sink(TraceSink::installed()), name(name), category(category), instance(instance) {
+        if (sink != nullptr) {
+            start = TraceSink::Clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (sink != nullptr) {
+            sink->record(name, category, start, TraceSink::Clock::now(), instance);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceSink* sink;
+    const char* name;
+    const char* category;
+    int64_t instance;
+    TraceSink::Clock::time_point start;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_TRACE_HPP
@@ -0,0 +1,183 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_tracked.cpp
+ * @brief Change notification for a wrapped Kvs instance
+ */
+
+#include "kvs_tracked.hpp"
+#include "kvs_metrics.hpp"
+#include "kvs_probes.hpp"
+#include "kvs_replay.hpp"
+#include "kvs_trace.hpp"
+#include <algorithm>
+
+namespace kvs_demo {
+
+bool TrackedKvs::add_listener(KvsListener& listener, bool replay_existing) {
+    listeners.push_back(&listener);
+    return !replay_existing || replay({&listener});
+}
+
+void TrackedKvs::remove_listener(KvsListener& listener) {
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), &listener), listeners.end());
+}
+
+score::ResultBlank TrackedKvs::set_value(std::string_view key, const KvsValue& value) {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Set, key, &value);
+    }
+    ProbeTimer timer(KVS_PROBE_ENABLED(set_value));
+    auto result = store.set_value(key, value);
+    if (KVS_PROBE_ENABLED(set_value)) {
+        KVS_PROBE3(set_value, instance, key.size(), timer.elapsed_ns());
+    }
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Set);
+    }
+    if (result) {
+        for (auto* listener : listeners) {
+            listener->on_set(key, value);
+        }
+    }
+    return result;
+}
+
+score::Result<KvsValue> TrackedKvs::get_value(std::string_view key) {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Get, key);
+    }
+    ProbeTimer timer(KVS_PROBE_ENABLED(get_value));
+    auto result = store.get_value(key);
+    if (KVS_PROBE_ENABLED(get_value)) {
+        KVS_PROBE3(get_value, instance, key.size(), timer.elapsed_ns());
+    }
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Get);
+    }
+    return result;
+}
+
+score::ResultBlank TrackedKvs::remove_key(std::string_view key) {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Remove, key);
+    }
+    auto result = store.remove_key(key);
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Remove);
+    }
+    if (result) {
+        for (auto* listener : listeners) {
+            listener->on_remove(key);
+        }
+    }
+    return result;
+}
+
+score::ResultBlank TrackedKvs::reset_key(std::string_view key) {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::ResetKey, key);
+    }
+    auto result = store.reset_key(key);
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Remove);
+    }
+    if (result) {
+        for (auto* listener : listeners) {
+            listener->on_remove(key);
+        }
+    }
+    return result;
+}
+
+score::ResultBlank TrackedKvs::reset() {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Reset);
+    }
+    auto result = store.reset();
+    if (result) {
+        resync();
+    }
+    return result;
+}
+
+score::ResultBlank TrackedKvs::snapshot_restore(const SnapshotId& snapshot_id) {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Restore, {}, nullptr, snapshot_id.id);
+    }
+    TraceSpan span("snapshot_restore", "kvs", static_cast<int64_t>(instance));
+    ProbeTimer timer(KVS_PROBE_ENABLED(snapshot_restore));
+    auto result = store.snapshot_restore(snapshot_id);
+    if (KVS_PROBE_ENABLED(snapshot_restore)) {
+        KVS_PROBE3(snapshot_restore, instance, snapshot_id.id, timer.elapsed_ns());
+    }
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Restore);
+    }
+    if (result) {
+        resync();
+    }
+    return result;
+}
+
+score::ResultBlank TrackedKvs::flush() {
+    if (recorder != nullptr) {
+        recorder->record(RecordedOp::Flush);
+    }
+    TraceSpan span("flush", "kvs", static_cast<int64_t>(instance));
+    ProbeTimer timer(KVS_PROBE_ENABLED(flush));
+    auto start = metrics != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    auto result = store.flush();
+    if (KVS_PROBE_ENABLED(flush)) {
+        KVS_PROBE2(flush, instance, timer.elapsed_ns());
+    }
+    if (metrics != nullptr) {
+        metrics->count(InstanceMetrics::Op::Flush);
+        if (result) {
+            metrics->flushed(std::chrono::steady_clock::now() - start);
+        }
+    }
+    if (result) {
+        for (auto* listener : listeners) {
+            listener->on_flush();
+        }
+    }
+    return result;
+}
+
+bool TrackedKvs::resync() {
+    for (auto* listener : listeners) {
+        listener->on_reset();
+    }
+    return replay(listeners);
+}
+
+bool TrackedKvs::replay(const std::vector<KvsListener*>& targets) {
+    auto keys_result = store.get_all_keys();
+    if (!keys_result) {
+        return false;
+    }
+    for (const auto& key : keys_result.value()) {
+        auto value_result = store.get_value(key);
+        if (!value_result) {
+            continue;
+        }
+        for (auto* listener : targets) {
+            listener->on_set(key, value_result.value());
+        }
+    }
+    return true;
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,108 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_tracked.hpp
+ * @brief Kvs wrapper that reports every change to registered listeners
+ *
+ * The library does not expose change notifications, so derived structures
+ * (indexes, caches, logs) hang off a TrackedKvs instead: all writes go
+ * through it, and each successful one is forwarded to the listeners in
+ * registration order. Writes made on the underlying Kvs directly are not
+ * seen; call resync() afterwards to rebuild the listeners' state.
+ *
+ * Like the Kvs it wraps, a TrackedKvs may be shared between threads only if
+ * its listeners are thread-safe; writes are not serialized here.
+ *
+ * set_value(), get_value(), flush() and snapshot_restore() fire the USDT
+ * probes of kvs_probes.hpp, tagged with the instance id given here, and
+ * feed the InstanceMetrics attached with attach_metrics(), if any. Every
+ * call is also logged to the OperationRecorder attached with
+ * attach_recorder(), for later replay (kvs_replay.hpp).
+ */
+
+#ifndef KVS_DEMO_TRACKED_HPP
+#define KVS_DEMO_TRACKED_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+class InstanceMetrics;
+class OperationRecorder;
+
+class KvsListener {
+public:
+    virtual ~KvsListener() = default;
+
+    /// key was written with value (also replayed for existing keys).
+    virtual void on_set(std::string_view key, const KvsValue& value) = 0;
+
+    /// key was removed or reset to its default.
+    virtual void on_remove(std::string_view key) = 0;
+
+    /// The store was flushed successfully.
+    virtual void on_flush() {}
+
+    /// Every key is gone; on_set() follows for keys that remain.
+    virtual void on_reset() = 0;
+};
+
+class TrackedKvs {
+public:
+    TrackedKvs(Kvs& kvs, InstanceId instance_id) : store(kvs), instance(instance_id.id) {}
+
+    /// Register listener and, unless replay_existing is false, replay the
+    /// current contents into it as on_set() calls. The listener must outlive
+    /// this object or be removed first.
+    bool add_listener(KvsListener& listener, bool replay_existing = true);
+    void remove_listener(KvsListener& listener);
+
+    score::ResultBlank set_value(std::string_view key, const KvsValue& value);
+    score::Result<KvsValue> get_value(std::string_view key);
+    score::ResultBlank remove_key(std::string_view key);
+    score::ResultBlank reset_key(std::string_view key);
+    score::ResultBlank reset();
+    score::ResultBlank snapshot_restore(const SnapshotId& snapshot_id);
+    score::ResultBlank flush();
+    score::Result<std::vector<std::string>> get_all_keys() { return store.get_all_keys(); }
+
+    /// Rebuild every listener from the current contents of the store.
+    bool resync();
+
+    /// Count operations and time flushes into metrics; nullptr detaches.
+    void attach_metrics(const InstanceMetrics* instance_metrics) { metrics = instance_metrics; }
+
+    /// Record every call from now on; nullptr detaches.
+    void attach_recorder(OperationRecorder* operation_recorder) { recorder = operation_recorder; }
+
+    Kvs& kvs() { return store; }
+
+private:
+    bool replay(const std::vector<KvsListener*>& targets);
+
+    Kvs& store;
+    size_t instance;
+    std::vector<KvsListener*> listeners;
+    const InstanceMetrics* metrics = nullptr;
+    OperationRecorder* recorder = nullptr;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_TRACKED_HPP
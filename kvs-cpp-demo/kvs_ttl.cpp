@@ -0,0 +1,269 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_ttl.cpp
+ * @brief Timer wheel and TTL bookkeeping for ExpiringKvs
+ */
+
+#include "kvs_ttl.hpp"
+#include "kvs_store_file.hpp"
+#include "kvs_value_codec.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace kvs_demo {
+
+namespace {
+
+int64_t wallClockMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point start)
+    : tick(std::max(tick, std::chrono::milliseconds(1))), origin(start) {}
+
+void TimerWheel::schedule(const std::string& key, Clock::time_point deadline) {
+    cancel(key);
+    // Round up so a timer never fires early, and never into the slot that
+    // has already been processed for the current tick
+    uint64_t expiry = current + 1;
+    if (deadline > origin) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - origin);
+        auto tick_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tick);
+        expiry = std::max(expiry, static_cast<uint64_t>((elapsed.count() + tick_ns.count() - 1) / tick_ns.count()));
+    }
+    Slot pending;
+    pending.push_back(Timer{key, expiry});
+    place(pending, pending.begin());
+}
+
+void TimerWheel::cancel(const std::string& key) {
+    auto found = timers.find(key);
+    if (found != timers.end()) {
+        found->second.slot->erase(found->second.timer);
+        timers.erase(found);
+    }
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::deadline(const std::string& key) const {
+    auto found = timers.find(key);
+    if (found == timers.end()) {
+        return std::nullopt;
+    }
+    return origin + tick * found->second.timer->expiry;
+}
+
+std::vector<std::pair<std::string, TimerWheel::Clock::time_point>> TimerWheel::deadlines() const {
+    std::vector<std::pair<std::string, Clock::time_point>> result;
+    result.reserve(timers.size());
+    for (const auto& [key, handle] : timers) {
+        result.emplace_back(key, origin + tick * handle.timer->expiry);
+    }
+    return result;
+}
+
+std::vector<std::string> TimerWheel::advance(Clock::time_point now) {
+    std::vector<std::string> expired;
+    if (now <= origin) {
+        return expired;
+    }
+    uint64_t target = static_cast<uint64_t>((now - origin) / tick);
+    if (timers.empty()) {
+        current = std::max(current, target);
+        return expired;
+    }
+
+    while (current < target) {
+        ++current;
+        // Bring down the upper-level slots whose range starts at this tick
+        for (unsigned level = LEVELS - 1; level > 0; --level) {
+            if ((current & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+
+        Slot due;
+        due.splice(due.begin(), levels[0][current & (SLOTS - 1)]);
+        while (!due.empty()) {
+            if (due.front().expiry <= current) {
+                expired.push_back(std::move(due.front().key));
+                timers.erase(expired.back());
+                due.pop_front();
+            } else {
+                place(due, due.begin());
+            }
+        }
+    }
+    return expired;
+}
+
+void TimerWheel::place(Slot& from, Slot::iterator it) {
+    uint64_t delta = it->expiry > current ? it->expiry - current : 0;
+    unsigned level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    // Park timers beyond the wheel's range in the farthest top-level slot
+    uint64_t position = it->expiry;
+    if (delta >= (uint64_t{1} << (SLOT_BITS * LEVELS))) {
+        position = current + (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    }
+
+    Slot& slot = levels[level][(position >> (SLOT_BITS * level)) & (SLOTS - 1)];
+    slot.splice(slot.end(), from, it);
+    timers[it->key] = Handle{&slot, it};
+}
+
+void TimerWheel::cascade(unsigned level) {
+    Slot pending;
+    pending.splice(pending.begin(), levels[level][(current >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+    while (!pending.empty()) {
+        place(pending, pending.begin());
+    }
+}
+
+ExpiringKvs::ExpiringKvs(TrackedKvs& tracked, const std::string& dir, InstanceId instance_id,
+                         std::chrono::milliseconds tick)
+    : tracked(tracked), ttl_path(storePath(dir, instance_id.id, "ttl.bin")), wheel(tick) {
+    tracked.add_listener(*this);
+}
+
+ExpiringKvs::~ExpiringKvs() {
+    tracked.remove_listener(*this);
+}
+
+bool ExpiringKvs::load() {
+    std::ifstream file(ttl_path, std::ios::binary);
+    if (!file) {
+        return true;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto saved = decodeValue(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    if (!saved || saved->getType() != KvsValue::Type::Object) {
+        return false;
+    }
+
+    int64_t now = wallClockMillis();
+    auto steady_now = TimerWheel::Clock::now();
+    for (const auto& [key, deadline] : std::get<KvsValue::Object>(saved->getValue())) {
+        if (!deadline || deadline->getType() != KvsValue::Type::i64) {
+            return false;
+        }
+        auto exists = tracked.kvs().key_exists(key);
+        if (!exists || !exists.value()) {
+            continue;
+        }
+        int64_t remaining = std::get<int64_t>(deadline->getValue()) - now;
+        if (remaining <= 0) {
+            tracked.remove_key(key);
+        } else {
+            wheel.schedule(key, steady_now + std::chrono::milliseconds(remaining));
+        }
+    }
+    return true;
+}
+
+bool ExpiringKvs::set_value(std::string_view key, const KvsValue& value, std::chrono::milliseconds ttl) {
+    if (!tracked.set_value(key, value)) {
+        return false;
+    }
+    wheel.schedule(std::string(key), TimerWheel::Clock::now() + ttl);
+    return true;
+}
+
+bool ExpiringKvs::expire(std::string_view key, std::chrono::milliseconds ttl) {
+    auto exists = tracked.kvs().key_exists(key);
+    if (!exists || !exists.value()) {
+        return false;
+    }
+    wheel.schedule(std::string(key), TimerWheel::Clock::now() + ttl);
+    return true;
+}
+
+std::optional<std::chrono::milliseconds> ExpiringKvs::ttl(std::string_view key) const {
+    auto deadline = wheel.deadline(std::string(key));
+    if (!deadline) {
+        return std::nullopt;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - TimerWheel::Clock::now());
+    return std::max(remaining, std::chrono::milliseconds(0));
+}
+
+std::optional<KvsValue> ExpiringKvs::get_value(std::string_view key) {
+    auto deadline = wheel.deadline(std::string(key));
+    if (deadline && *deadline <= TimerWheel::Clock::now()) {
+        tracked.remove_key(key);
+        return std::nullopt;
+    }
+    auto value_result = tracked.get_value(key);
+    if (!value_result) {
+        return std::nullopt;
+    }
+    return value_result.value();
+}
+
+size_t ExpiringKvs::expire_now() {
+    auto expired = wheel.advance(TimerWheel::Clock::now());
+    for (const auto& key : expired) {
+        tracked.remove_key(key);
+    }
+    return expired.size();
+}
+
+bool ExpiringKvs::flush() {
+    expire_now();
+    // Deadlines go first: a crash in between must not persist TTL keys
+    // without their deadlines. Stale deadlines of keys the store does not
+    // hold are dropped by load().
+    if (!saveDeadlines()) {
+        return false;
+    }
+    return static_cast<bool>(tracked.flush());
+}
+
+void ExpiringKvs::on_set(std::string_view key, const KvsValue&) {
+    wheel.cancel(std::string(key));
+}
+
+void ExpiringKvs::on_remove(std::string_view key) {
+    wheel.cancel(std::string(key));
+}
+
+void ExpiringKvs::on_reset() {
+    for (const auto& [key, deadline] : wheel.deadlines()) {
+        wheel.cancel(key);
+    }
+}
+
+bool ExpiringKvs::saveDeadlines() const {
+    // Stored as wall-clock times, since the steady clock restarts with the process
+    auto steady_now = TimerWheel::Clock::now();
+    int64_t now = wallClockMillis();
+    KvsValue::Object saved;
+    for (const auto& [key, deadline] : wheel.deadlines()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - steady_now).count();
+        saved[key] = std::make_shared<KvsValue>(KvsValue(now + std::max<int64_t>(remaining, 0)));
+    }
+
+    std::string encoded;
+    SyscallCounter counter;
+    return encodeValue(KvsValue(saved), encoded) && writeFileAtomically(ttl_path, encoded, counter);
+}
+
+} // namespace kvs_demo
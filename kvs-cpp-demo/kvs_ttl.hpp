@@ -0,0 +1,139 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_ttl.hpp
+ * @brief Per-key time-to-live backed by a hierarchical timer wheel
+ *
+ * TimerWheel has four levels of 64 slots. A timer goes into the level whose
+ * range covers its distance from the current tick, so scheduling and
+ * cancelling are O(1); when a lower level wraps, the next slot of the level
+ * above is cascaded down. Deadlines beyond the top level (64^4 ticks) are
+ * parked in it and re-placed when they come round.
+ *
+ * ExpiringKvs adds TTLs to a TrackedKvs:
+ * - get_value() expires a key lazily if its deadline has passed
+ * - flush() first removes every expired key in one batch, so expired
+ *   values never reach the store file
+ * - deadlines are kept as wall-clock times in kvs_<id>_ttl.bin, written
+ *   just before each flush of the store and re-armed by load()
+ * A plain set_value() or remove_key() through the TrackedKvs clears the TTL
+ * of that key; reset() and snapshot_restore() clear all of them.
+ */
+
+#ifndef KVS_DEMO_TTL_HPP
+#define KVS_DEMO_TTL_HPP
+
+#include "kvs_tracked.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kvs_demo {
+
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10), Clock::time_point start = Clock::now());
+
+    /// Arm (or re-arm) the timer for key.
+    void schedule(const std::string& key, Clock::time_point deadline);
+    void cancel(const std::string& key);
+
+    std::optional<Clock::time_point> deadline(const std::string& key) const;
+    std::vector<std::pair<std::string, Clock::time_point>> deadlines() const;
+    size_t size() const { return timers.size(); }
+
+    /// Move the wheel forward to now and return the keys that expired.
+    std::vector<std::string> advance(Clock::time_point now);
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr uint64_t SLOTS = uint64_t{1} << SLOT_BITS;
+    static constexpr unsigned LEVELS = 4;
+
+    struct Timer {
+        std::string key;
+        uint64_t expiry;
+    };
+    using Slot = std::list<Timer>;
+
+    struct Handle {
+        Slot* slot;
+        Slot::iterator timer;
+    };
+
+    /// Move the timer at it from its current list into its slot.
+    void place(Slot& from, Slot::iterator it);
+    void cascade(unsigned level);
+
+    std::chrono::milliseconds tick;
+    Clock::time_point origin;
+    uint64_t current = 0;
+    std::array<std::array<Slot, SLOTS>, LEVELS> levels;
+    std::unordered_map<std::string, Handle> timers;
+};
+
+class ExpiringKvs : public KvsListener {
+public:
+    ExpiringKvs(TrackedKvs& tracked, const std::string& dir, InstanceId instance_id,
+                std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+    ~ExpiringKvs() override;
+
+    ExpiringKvs(const ExpiringKvs&) = delete;
+    ExpiringKvs& operator=(const ExpiringKvs&) = delete;
+
+    /// Re-arm the TTLs saved by the last flush; keys already past their
+    /// deadline are removed. Returns false only on a corrupted TTL file.
+    bool load();
+
+    bool set_value(std::string_view key, const KvsValue& value, std::chrono::milliseconds ttl);
+
+    /// Set or replace the TTL of an existing key.
+    bool expire(std::string_view key, std::chrono::milliseconds ttl);
+
+    /// Remaining time to live, or nothing if the key has no TTL.
+    std::optional<std::chrono::milliseconds> ttl(std::string_view key) const;
+
+    /// The value, or nothing if the key is missing or has just expired.
+    std::optional<KvsValue> get_value(std::string_view key);
+
+    /// Remove every key whose deadline has passed; returns how many.
+    size_t expire_now();
+
+    /// expire_now(), then save the remaining TTLs and flush the store.
+    bool flush();
+
+    void on_set(std::string_view key, const KvsValue& value) override;
+    void on_remove(std::string_view key) override;
+    void on_reset() override;
+
+private:
+    bool saveDeadlines() const;
+
+    TrackedKvs& tracked;
+    std::string ttl_path;
+    TimerWheel wheel;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_TTL_HPP
@@ -0,0 +1,212 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_value_cache.cpp
+ * @brief CLOCK-managed resident set of an instance's values
+ */
+
+#include "kvs_value_cache.hpp"
+#include "kvs_value_codec.hpp"
+
+namespace kvs_demo {
+
+namespace {
+
+struct BlobInfo {
+    std::string name;
+    size_t size;
+};
+
+std::optional<BlobInfo> blobInfo(const KvsValue& value) {
+    if (!BlobStore::isReference(value) || BlobStore::isBytes(value)) {
+        return std::nullopt;
+    }
+    const auto& object = std::get<KvsValue::Object>(value.getValue());
+    const auto& size = object.at("$size");
+    if (!size || size->getType() != KvsValue::Type::u64) {
+        return std::nullopt;
+    }
+    return BlobInfo{std::get<std::string>(object.at("$blob")->getValue()),
+                    static_cast<size_t>(std::get<uint64_t>(size->getValue()))};
+}
+
+} // namespace
+
+ResidentValueCache::ResidentValueCache(Kvs& kvs, BlobStore& blobs, size_t budget_bytes)
+    : kvs(kvs), blobs(blobs), budget_bytes(budget_bytes) {}
+
+bool ResidentValueCache::load() {
+    auto keys = kvs.get_all_keys();
+    if (!keys) {
+        return false;
+    }
+    bool within_budget = true;
+    for (const auto& key : keys.value()) {
+        if (index.count(key) != 0) {
+            continue;
+        }
+        auto stored = kvs.get_value(key);
+        // Values already out of line are not resident until they are read
+        if (stored && !BlobStore::isReference(stored.value())) {
+            within_budget &= admit(Entry{Residency::Inline, key, {}, nullptr, encodedSize(stored.value()), false});
+        }
+    }
+    return within_budget;
+}
+
+bool ResidentValueCache::set_value(const std::string& key, const KvsValue& value) {
+    invalidate(key);
+    if (!blobs.set_value(kvs, key, value)) {
+        return false;
+    }
+    auto stored = kvs.get_value(key);
+    if (!stored) {
+        return false;
+    }
+    if (auto info = blobInfo(stored.value())) {
+        return admit(Entry{Residency::Decoded, key, info->name, std::make_shared<const KvsValue>(value), info->size,
+                           true});
+    }
+    return admit(Entry{Residency::Inline, key, {}, nullptr, encodedSize(value), true});
+}
+
+std::optional<KvsValue> ResidentValueCache::get_value(const std::string& key) {
+    auto stored = kvs.get_value(key);
+    if (!stored) {
+        invalidate(key);
+        return std::nullopt;
+    }
+    if (BlobStore::isBytes(stored.value())) {
+        // Raw bytes are mapped by get_bytes(), never decoded
+        return stored.value();
+    }
+
+    auto info = blobInfo(stored.value());
+    auto found = index.find(key);
+    if (found != index.end()) {
+        Entry& entry = ring[found->second];
+        // The key may have been rewritten behind the cache's back
+        if (info ? entry.residency == Residency::Decoded && entry.blob == info->name
+                 : entry.residency == Residency::Inline) {
+            entry.referenced = true;
+            ++counters.hits;
+            return info ? *entry.value : stored.value();
+        }
+        removeSlot(found->second);
+    }
+
+    if (!info) {
+        admit(Entry{Residency::Inline, key, {}, nullptr, encodedSize(stored.value()), true});
+        return stored.value();
+    }
+
+    ++counters.misses;
+    // Decoding reads every byte anyway, so the full check costs little
+    auto blob = blobs.map(stored.value(), BlobCheck::Contents);
+    if (!blob) {
+        return std::nullopt;
+    }
+    auto value = decodeValue(blob->data(), blob->size());
+    if (value) {
+        admit(Entry{Residency::Decoded, key, info->name, std::make_shared<const KvsValue>(*value), info->size, true});
+    }
+    return value;
+}
+
+void ResidentValueCache::invalidate(const std::string& key) {
+    auto found = index.find(key);
+    if (found != index.end()) {
+        removeSlot(found->second);
+    }
+}
+
+bool ResidentValueCache::set_budget(size_t budget) {
+    budget_bytes = budget;
+    return evictFor(0);
+}
+
+bool ResidentValueCache::admit(Entry entry) {
+    if (entry.size > budget_bytes) {
+        // A decoded copy bigger than the whole budget is not kept; an inline one goes straight to disk
+        if (entry.residency == Residency::Decoded || spillInline(entry.key, entry.size)) {
+            return true;
+        }
+    } else {
+        evictFor(entry.size);
+    }
+
+    size_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = ring.size();
+        ring.emplace_back();
+    }
+    index[entry.key] = slot;
+    resident_bytes += entry.size;
+    ring[slot] = std::move(entry);
+    // An entry there was no room for is still charged, so the overrun shows in residentBytes()
+    return resident_bytes <= budget_bytes;
+}
+
+bool ResidentValueCache::evictFor(size_t size) {
+    // Two sweeps without an eviction clear every reference bit and find
+    // nothing evictable, so give up then
+    size_t idle = 0;
+    while (resident_bytes + size > budget_bytes && idle < 2 * ring.size()) {
+        hand %= ring.size();
+        size_t slot = hand++;
+        Entry& entry = ring[slot];
+        if (entry.residency == Residency::Empty) {
+            ++idle;
+        } else if (entry.referenced) {
+            entry.referenced = false;
+            ++idle;
+        } else if (entry.residency == Residency::Decoded || spillInline(entry.key, entry.size)) {
+            removeSlot(slot);
+            ++counters.evictions;
+            idle = 0;
+        } else {
+            ++idle;
+        }
+    }
+    return resident_bytes + size <= budget_bytes;
+}
+
+bool ResidentValueCache::spillInline(const std::string& key, size_t size) {
+    if (size <= min_spill_size) {
+        return false;
+    }
+    auto stored = kvs.get_value(key);
+    if (!stored || BlobStore::isReference(stored.value())) {
+        // Removed or moved out of line behind the cache's back: nothing left to spill
+        return true;
+    }
+    if (!blobs.spill(kvs, key, stored.value())) {
+        return false;
+    }
+    ++counters.spills;
+    return true;
+}
+
+void ResidentValueCache::removeSlot(size_t slot) {
+    Entry& entry = ring[slot];
+    resident_bytes -= entry.size;
+    index.erase(entry.key);
+    entry = Entry{};
+    free_slots.push_back(slot);
+}
+
+} // namespace kvs_demo
@@ -0,0 +1,119 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_value_cache.hpp
+ * @brief Per-instance memory budget, with CLOCK eviction to disk
+ *
+ * A ResidentValueCache charges everything the instance keeps in memory for
+ * its values against a byte budget: values held inline by the Kvs, and
+ * decoded copies of values stored out of line as blobs
+ * (kvs_blob_store.hpp). When the budget is exceeded, the CLOCK hand sweeps
+ * the entries: a recently used entry loses its reference bit and survives
+ * one more round, an unused one is evicted. Evicting a decoded copy drops
+ * it; evicting an inline value spills it to a blob file, so the Kvs only
+ * keeps its reference. get_value() faults an evicted value back in from
+ * its blob file, so hot values stay resident while cold ones only cost
+ * disk space.
+ *
+ * Sizes are accounted by encoded size, a close proxy for the decoded tree.
+ * The references themselves are not charged, and values no larger than
+ * min_spill_size are charged but never spilled, since their reference
+ * would take about as much memory. Writes that bypass the cache are picked
+ * up by the next get_value() of the key, or by load(). Raw bytes from
+ * set_bytes() are mapped, never decoded, and are not charged.
+ */
+
+#ifndef KVS_DEMO_VALUE_CACHE_HPP
+#define KVS_DEMO_VALUE_CACHE_HPP
+
+#include "kvs_blob_store.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kvs_demo {
+
+class ResidentValueCache {
+public:
+    static constexpr size_t min_spill_size = 128;
+
+    // Atomic so that a metrics thread can read them while the cache is in use
+    struct Stats {
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> evictions{0};
+        std::atomic<size_t> spills{0};      ///< Inline values moved to a blob
+    };
+
+    ResidentValueCache(Kvs& kvs, BlobStore& blobs, size_t budget_bytes);
+
+    /// Charge the values already in the instance, spilling as needed. False
+    /// if the keys cannot be listed or the budget cannot be met.
+    bool load();
+
+    /// Store value through the blob store; it starts out resident. False if
+    /// the write fails or the budget cannot be met.
+    bool set_value(const std::string& key, const KvsValue& value);
+
+    /// The value under key, from memory or faulted in from its blob.
+    std::optional<KvsValue> get_value(const std::string& key);
+
+    /// Stop charging key, e.g. after removing it.
+    void invalidate(const std::string& key);
+
+    /// Change the budget, evicting as needed.
+    bool set_budget(size_t budget);
+
+    size_t budget() const { return budget_bytes; }
+    size_t residentBytes() const { return resident_bytes; }
+    size_t residentCount() const { return index.size(); }
+    const Stats& stats() const { return counters; }
+
+private:
+    enum class Residency { Empty, Inline, Decoded };
+
+    struct Entry {
+        Residency residency = Residency::Empty;
+        std::string key;
+        std::string blob;                               ///< Decoded only
+        std::shared_ptr<const KvsValue> value;          ///< Decoded only; inline values stay in the Kvs
+        size_t size = 0;
+        bool referenced = false;
+    };
+
+    bool admit(Entry entry);
+    bool evictFor(size_t size);
+    bool spillInline(const std::string& key, size_t size);
+    void removeSlot(size_t slot);
+
+    Kvs& kvs;
+    BlobStore& blobs;
+    size_t budget_bytes;
+    size_t resident_bytes = 0;
+
+    // CLOCK ring; empty slots are reused first
+    std::vector<Entry> ring;
+    std::vector<size_t> free_slots;
+    std::unordered_map<std::string, size_t> index;
+    size_t hand = 0;
+    Stats counters;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_VALUE_CACHE_HPP
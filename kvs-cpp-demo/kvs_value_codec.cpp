@@ -0,0 +1,490 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_value_codec.cpp
+ * @brief Binary encoder and decoder for KvsValue trees
+ */
+
+#include "kvs_value_codec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace kvs_demo {
+
+namespace {
+
+constexpr uint8_t TAG_BACK_REFERENCE = 0x80;
+constexpr size_t BACK_REFERENCE_SIZE = 1 + 4;
+
+bool isShareable(KvsValue::Type type) {
+    return type == KvsValue::Type::String || type == KvsValue::Type::Array || type == KvsValue::Type::Object;
+}
+
+template <typename T>
+void putLittleEndian(std::string& out, T value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::reverse(bytes, bytes + sizeof(T));
+#endif
+    out.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+void putLength(std::string& out, size_t length) {
+    putLittleEndian<uint32_t>(out, static_cast<uint32_t>(length));
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size - offset < sizeof(T)) {
+            return false;
+        }
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, data + offset, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        std::reverse(bytes, bytes + sizeof(T));
+#endif
+        std::memcpy(&value, bytes, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t length = 0;
+        if (!get(length) || size - offset < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return true;
+    }
+
+    std::shared_ptr<KvsValue> getShared(int depth) {
+        // Bound recursion so corrupted input cannot blow the stack
+        if (depth > max_nesting_depth) {
+            return nullptr;
+        }
+        uint8_t tag = 0;
+        if (!get(tag)) {
+            return nullptr;
+        }
+
+        if (tag == TAG_BACK_REFERENCE) {
+            uint32_t index = 0;
+            return get(index) && index < shared.size() ? shared[index] : nullptr;
+        }
+
+        switch (static_cast<KvsValue::Type>(tag)) {
+            case KvsValue::Type::i32:
+                return getScalar<int32_t>();
+            case KvsValue::Type::u32:
+                return getScalar<uint32_t>();
+            case KvsValue::Type::i64:
+                return getScalar<int64_t>();
+            case KvsValue::Type::u64:
+                return getScalar<uint64_t>();
+            case KvsValue::Type::f64:
+                return getScalar<double>();
+            case KvsValue::Type::Boolean: {
+                uint8_t v;
+                return get(v) ? std::make_shared<KvsValue>(v != 0) : nullptr;
+            }
+            case KvsValue::Type::String: {
+                std::string v;
+                return getString(v) ? share(KvsValue(v)) : nullptr;
+            }
+            case KvsValue::Type::Null:
+                return std::make_shared<KvsValue>(nullptr);
+            case KvsValue::Type::Array: {
+                uint32_t count = 0;
+                if (!get(count)) {
+                    return nullptr;
+                }
+                KvsValue::Array array;
+                for (uint32_t i = 0; i < count; ++i) {
+                    auto element = getShared(depth + 1);
+                    if (!element) {
+                        return nullptr;
+                    }
+                    array.push_back(std::move(element));
+                }
+                return share(KvsValue(array));
+            }
+            case KvsValue::Type::Object: {
+                uint32_t count = 0;
+                if (!get(count)) {
+                    return nullptr;
+                }
+                KvsValue::Object object;
+                for (uint32_t i = 0; i < count; ++i) {
+                    std::string key;
+                    if (!getString(key)) {
+                        return nullptr;
+                    }
+                    auto element = getShared(depth + 1);
+                    if (!element) {
+                        return nullptr;
+                    }
+                    object[key] = std::move(element);
+                }
+                return share(KvsValue(object));
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+    // Every decoded String, Array and Object, numbered for back-references
+    std::vector<std::shared_ptr<KvsValue>> shared;
+
+    template <typename T>
+    std::shared_ptr<KvsValue> getScalar() {
+        T v;
+        return get(v) ? std::make_shared<KvsValue>(v) : nullptr;
+    }
+
+    std::shared_ptr<KvsValue> share(KvsValue value) {
+        shared.push_back(std::make_shared<KvsValue>(std::move(value)));
+        return shared.back();
+    }
+};
+
+class SharingEncoder {
+public:
+    explicit SharingEncoder(std::string& out) : out(out) {}
+
+    bool encode(const KvsValue* value, int depth) {
+        if (depth > max_nesting_depth) {
+            return false;
+        }
+        if (value == nullptr) {
+            out.push_back(static_cast<char>(KvsValue::Type::Null));
+            return true;
+        }
+
+        KvsValue::Type type = value->getType();
+        if (!isShareable(type)) {
+            return encodeValue(*value, out);
+        }
+
+        const Summary& summary = summarize(value);
+        if (summary.size > BACK_REFERENCE_SIZE) {
+            auto range = written.equal_range(summary.hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (valuesEqual(*it->second.value, *value)) {
+                    out.push_back(static_cast<char>(TAG_BACK_REFERENCE));
+                    putLength(out, it->second.index);
+                    return true;
+                }
+            }
+        }
+
+        if (type == KvsValue::Type::String) {
+            encodeValue(*value, out);
+        } else if (type == KvsValue::Type::Array) {
+            const auto& array = std::get<KvsValue::Array>(value->getValue());
+            out.push_back(static_cast<char>(type));
+            putLength(out, array.size());
+            for (const auto& element : array) {
+                if (!encode(element.get(), depth + 1)) {
+                    return false;
+                }
+            }
+        } else {
+            const auto& object = std::get<KvsValue::Object>(value->getValue());
+            out.push_back(static_cast<char>(type));
+            putLength(out, object.size());
+            for (const auto* entry : sortedEntries(object)) {
+                putLength(out, entry->first.size());
+                out.append(entry->first);
+                if (!encode(entry->second.get(), depth + 1)) {
+                    return false;
+                }
+            }
+        }
+
+        // Numbered in completion order, exactly as the Reader numbers them
+        uint32_t index = next_index++;
+        if (summary.size > BACK_REFERENCE_SIZE) {
+            written.emplace(summary.hash, Written{value, index});
+        }
+        return true;
+    }
+
+private:
+    struct Summary {
+        uint64_t hash;
+        size_t size;
+    };
+
+    struct Written {
+        const KvsValue* value;
+        uint32_t index;
+    };
+
+    static std::vector<const KvsValue::Object::value_type*> sortedEntries(const KvsValue::Object& object) {
+        std::vector<const KvsValue::Object::value_type*> entries;
+        entries.reserve(object.size());
+        for (const auto& entry : object) {
+            entries.push_back(&entry);
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+        return entries;
+    }
+
+    /// Content hash and plain encoded size, computed once per node.
+    const Summary& summarize(const KvsValue* value) {
+        auto found = summaries.find(value);
+        if (found != summaries.end()) {
+            return found->second;
+        }
+
+        std::string key_material;
+        size_t size = 0;
+        switch (value->getType()) {
+            case KvsValue::Type::Array: {
+                const auto& array = std::get<KvsValue::Array>(value->getValue());
+                key_material.push_back(static_cast<char>(KvsValue::Type::Array));
+                putLittleEndian<uint64_t>(key_material, array.size());
+                size = 1 + 4;
+                for (const auto& element : array) {
+                    Summary child = summarizeChild(element.get());
+                    putLittleEndian(key_material, child.hash);
+                    size += child.size;
+                }
+                break;
+            }
+            case KvsValue::Type::Object: {
+                const auto& object = std::get<KvsValue::Object>(value->getValue());
+                key_material.push_back(static_cast<char>(KvsValue::Type::Object));
+                putLittleEndian<uint64_t>(key_material, object.size());
+                size = 1 + 4;
+                for (const auto* entry : sortedEntries(object)) {
+                    Summary child = summarizeChild(entry->second.get());
+                    putLength(key_material, entry->first.size());
+                    key_material.append(entry->first);
+                    putLittleEndian(key_material, child.hash);
+                    size += 4 + entry->first.size() + child.size;
+                }
+                break;
+            }
+            default:
+                encodeValue(*value, key_material);
+                size = key_material.size();
+                break;
+        }
+        return summaries.emplace(value, Summary{fnv1a64(key_material.data(), key_material.size()), size}).first->second;
+    }
+
+    Summary summarizeChild(const KvsValue* value) {
+        if (value == nullptr) {
+            const char null_tag = static_cast<char>(KvsValue::Type::Null);
+            return Summary{fnv1a64(&null_tag, 1), 1};
+        }
+        return summarize(value);
+    }
+
+    std::string& out;
+    std::unordered_map<const KvsValue*, Summary> summaries;
+    std::unordered_multimap<uint64_t, Written> written;
+    uint32_t next_index = 0;
+};
+
+bool encodeNested(const KvsValue& value, std::string& out, int depth) {
+    if (depth > max_nesting_depth) {
+        return false;
+    }
+    out.push_back(static_cast<char>(value.getType()));
+    switch (value.getType()) {
+        case KvsValue::Type::i32:
+            putLittleEndian(out, std::get<int32_t>(value.getValue()));
+            break;
+        case KvsValue::Type::u32:
+            putLittleEndian(out, std::get<uint32_t>(value.getValue()));
+            break;
+        case KvsValue::Type::i64:
+            putLittleEndian(out, std::get<int64_t>(value.getValue()));
+            break;
+        case KvsValue::Type::u64:
+            putLittleEndian(out, std::get<uint64_t>(value.getValue()));
+            break;
+        case KvsValue::Type::f64:
+            putLittleEndian(out, std::get<double>(value.getValue()));
+            break;
+        case KvsValue::Type::Boolean:
+            out.push_back(std::get<bool>(value.getValue()) ? 1 : 0);
+            break;
+        case KvsValue::Type::String: {
+            const auto& str = std::get<std::string>(value.getValue());
+            putLength(out, str.size());
+            out.append(str);
+            break;
+        }
+        case KvsValue::Type::Null:
+            break;
+        case KvsValue::Type::Array: {
+            const auto& array = std::get<KvsValue::Array>(value.getValue());
+            putLength(out, array.size());
+            for (const auto& element : array) {
+                if (!encodeNested(element ? *element : KvsValue(nullptr), out, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        case KvsValue::Type::Object: {
+            const auto& object = std::get<KvsValue::Object>(value.getValue());
+            putLength(out, object.size());
+            for (const auto& [key, element] : object) {
+                putLength(out, key.size());
+                out.append(key);
+                if (!encodeNested(element ? *element : KvsValue(nullptr), out, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool encodeValue(const KvsValue& value, std::string& out) {
+    size_t start = out.size();
+    if (!encodeNested(value, out, 0)) {
+        out.resize(start);
+        return false;
+    }
+    return true;
+}
+
+size_t encodedSize(const KvsValue& value) {
+    switch (value.getType()) {
+        case KvsValue::Type::i32:
+        case KvsValue::Type::u32:
+            return 1 + 4;
+        case KvsValue::Type::i64:
+        case KvsValue::Type::u64:
+        case KvsValue::Type::f64:
+            return 1 + 8;
+        case KvsValue::Type::Boolean:
+            return 1 + 1;
+        case KvsValue::Type::String:
+            return 1 + 4 + std::get<std::string>(value.getValue()).size();
+        case KvsValue::Type::Null:
+            return 1;
+        case KvsValue::Type::Array: {
+            size_t size = 1 + 4;
+            for (const auto& element : std::get<KvsValue::Array>(value.getValue())) {
+                size += element ? encodedSize(*element) : 1;
+            }
+            return size;
+        }
+        case KvsValue::Type::Object: {
+            size_t size = 1 + 4;
+            for (const auto& [key, element] : std::get<KvsValue::Object>(value.getValue())) {
+                size += 4 + key.size() + (element ? encodedSize(*element) : 1);
+            }
+            return size;
+        }
+    }
+    return 1;
+}
+
+bool encodeValueShared(const KvsValue& value, std::string& out) {
+    size_t start = out.size();
+    SharingEncoder encoder(out);
+    if (!encoder.encode(&value, 0)) {
+        out.resize(start);
+        return false;
+    }
+    return true;
+}
+
+std::optional<KvsValue> decodeValue(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    auto value = reader.getShared(0);
+    if (!value) {
+        return std::nullopt;
+    }
+    return *value;
+}
+
+bool valuesEqual(const KvsValue& a, const KvsValue& b) {
+    if (a.getType() != b.getType()) {
+        return false;
+    }
+    switch (a.getType()) {
+        case KvsValue::Type::f64: {
+            double x = std::get<double>(a.getValue());
+            double y = std::get<double>(b.getValue());
+            return std::memcmp(&x, &y, sizeof(double)) == 0;
+        }
+        case KvsValue::Type::Array: {
+            const auto& x = std::get<KvsValue::Array>(a.getValue());
+            const auto& y = std::get<KvsValue::Array>(b.getValue());
+            if (x.size() != y.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < x.size(); ++i) {
+                if (x[i] != y[i] && !valuesEqual(x[i] ? *x[i] : KvsValue(nullptr), y[i] ? *y[i] : KvsValue(nullptr))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case KvsValue::Type::Object: {
+            const auto& x = std::get<KvsValue::Object>(a.getValue());
+            const auto& y = std::get<KvsValue::Object>(b.getValue());
+            if (x.size() != y.size()) {
+                return false;
+            }
+            for (const auto& [key, element] : x) {
+                auto other = y.find(key);
+                if (other == y.end()) {
+                    return false;
+                }
+                if (element != other->second &&
+                    !valuesEqual(element ? *element : KvsValue(nullptr), other->second ? *other->second : KvsValue(nullptr))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return a.getValue() == b.getValue();
+    }
+}
+
+uint64_t fnv1a64(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace kvs_demo
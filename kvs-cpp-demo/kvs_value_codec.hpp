@@ -0,0 +1,73 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_value_codec.hpp
+ * @brief Compact binary encoding of KvsValue trees
+ *
+ * Every value is a one-byte tag (the KvsValue::Type ordinal) followed by its
+ * payload, all integers little-endian:
+ * - i32/u32: 4 bytes, i64/u64/f64: 8 bytes, Boolean: 1 byte, Null: nothing
+ * - String: u32 length + bytes (so the bytes can be viewed in place)
+ * - Array: u32 count + elements
+ * - Object: u32 count + (u32 key length, key bytes, value) per entry
+ *
+ * encodeValueShared() additionally numbers every String, Array and Object in
+ * the order its encoding completes, and writes a repeat of an earlier one as
+ * tag 0x80 + u32 number. decodeValue() resolves these back-references to the
+ * same shared_ptr, so repeated subtrees are also shared after decoding.
+ *
+ * Arrays and Objects nest at most max_nesting_depth levels below the root.
+ * The decoder enforces this to bound its recursion, so the encoders refuse
+ * deeper values instead of producing data that could not be read back.
+ */
+
+#ifndef KVS_DEMO_VALUE_CODEC_HPP
+#define KVS_DEMO_VALUE_CODEC_HPP
+
+#include "kvs/kvsbuilder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kvs_demo {
+
+using namespace score::mw::per::kvs;
+
+constexpr int max_nesting_depth = 64;
+
+/// Append the encoding of value to out. Returns false, leaving out as it
+/// was, if value nests deeper than max_nesting_depth.
+bool encodeValue(const KvsValue& value, std::string& out);
+
+/// Like encodeValue(), but repeated subtrees become back-references.
+/// Object keys are written in sorted order so equal objects encode alike.
+bool encodeValueShared(const KvsValue& value, std::string& out);
+
+/// Number of bytes encodeValue() would append, without encoding.
+size_t encodedSize(const KvsValue& value);
+
+/// Decode one value from data; returns nothing on truncated or invalid input.
+std::optional<KvsValue> decodeValue(const uint8_t* data, size_t size);
+
+/// Deep comparison; f64 values compare by bit pattern.
+bool valuesEqual(const KvsValue& a, const KvsValue& b);
+
+/// 64-bit FNV-1a, used to content-address encoded values.
+uint64_t fnv1a64(const void* data, size_t size);
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_VALUE_CODEC_HPP
@@ -0,0 +1,196 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_warm_image.cpp
+ * @brief Writer and in-place reader of warm-start images
+ */
+
+#include "kvs_warm_image.hpp"
+#include "kvs_store_file.hpp"
+#include "kvs_value_codec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace kvs_demo {
+
+namespace {
+
+constexpr char IMAGE_MAGIC[4] = {'K', 'V', 'W', 'I'};
+constexpr uint32_t IMAGE_VERSION = 2;
+constexpr size_t IMAGE_HEADER_SIZE = 32;
+constexpr size_t IMAGE_ENTRY_SIZE = 16;
+
+template <typename T>
+void putLittleEndian(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+template <typename T>
+T getLittleEndian(const uint8_t* in) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+struct SourceIdentity {
+    uint64_t hash;
+    uint64_t size;
+};
+
+/// FNV-1a 64 and size of the current JSON generation; the hash is skipped
+/// (left 0) when the size already differs from expected_size.
+std::optional<SourceIdentity> sourceIdentity(const std::string& prefix,
+                                             std::optional<uint64_t> expected_size = std::nullopt) {
+    struct stat info;
+    if (::stat((prefix + ".json").c_str(), &info) != 0) {
+        return std::nullopt;
+    }
+    SourceIdentity identity{0, static_cast<uint64_t>(info.st_size)};
+    if (expected_size && *expected_size != identity.size) {
+        return identity;
+    }
+    auto json = mapFile(prefix + ".json");
+    if (!json || json->size() != identity.size) {
+        return std::nullopt;
+    }
+    identity.hash = fnv1a64(json->data(), json->size());
+    return identity;
+}
+
+} // namespace
+
+bool WarmImage::write(Kvs& kvs, const std::string& dir, InstanceId instance_id) {
+    std::string prefix = generationPath(dir, instance_id.id, 0);
+    auto source = sourceIdentity(prefix);
+    auto keys_result = kvs.get_all_keys();
+    if (!source || !keys_result) {
+        return false;
+    }
+    std::vector<std::string> keys = keys_result.value();
+    std::sort(keys.begin(), keys.end());
+
+    std::string table;
+    std::string data;
+    for (const auto& key : keys) {
+        auto value_result = kvs.get_value(key);
+        if (!value_result) {
+            return false;
+        }
+        putLittleEndian<uint32_t>(table, static_cast<uint32_t>(data.size()));
+        putLittleEndian<uint32_t>(table, static_cast<uint32_t>(key.size()));
+        data.append(key);
+        size_t value_offset = data.size();
+        if (!encodeValue(value_result.value(), data)) {
+            return false;
+        }
+        putLittleEndian<uint32_t>(table, static_cast<uint32_t>(value_offset));
+        putLittleEndian<uint32_t>(table, static_cast<uint32_t>(data.size() - value_offset));
+        if (data.size() > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    std::string image(IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    putLittleEndian<uint32_t>(image, IMAGE_VERSION);
+    putLittleEndian<uint64_t>(image, source->hash);
+    putLittleEndian<uint64_t>(image, source->size);
+    putLittleEndian<uint64_t>(image, keys.size());
+    image.append(table);
+    image.append(data);
+
+    SyscallCounter counter;
+    return writeFileAtomically(prefix + ".img", image, counter);
+}
+
+std::optional<WarmImage> WarmImage::open(const std::string& dir, InstanceId instance_id) {
+    std::string prefix = generationPath(dir, instance_id.id, 0);
+    auto mapping = mapFile(prefix + ".img");
+    if (!mapping || mapping->size() < IMAGE_HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    const uint8_t* header = mapping->data();
+    if (std::memcmp(header, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 ||
+        getLittleEndian<uint32_t>(header + 4) != IMAGE_VERSION) {
+        return std::nullopt;
+    }
+    // Stale if the store was flushed again since the image was written
+    uint64_t image_size = getLittleEndian<uint64_t>(header + 16);
+    auto source = sourceIdentity(prefix, image_size);
+    if (!source || source->size != image_size || source->hash != getLittleEndian<uint64_t>(header + 8)) {
+        return std::nullopt;
+    }
+    uint64_t count = getLittleEndian<uint64_t>(header + 24);
+    if ((mapping->size() - IMAGE_HEADER_SIZE) / IMAGE_ENTRY_SIZE < count) {
+        return std::nullopt;
+    }
+    return WarmImage(std::move(*mapping), count);
+}
+
+std::optional<KvsValue> WarmImage::get_value(std::string_view key) const {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        auto candidate = entry(middle);
+        if (!candidate) {
+            return std::nullopt;
+        }
+        if (candidate->key < key) {
+            low = middle + 1;
+        } else if (key < candidate->key) {
+            high = middle;
+        } else {
+            return decodeValue(candidate->value, candidate->value_size);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> WarmImage::get_all_keys() const {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (auto e = entry(i)) {
+            keys.emplace_back(e->key);
+        }
+    }
+    return keys;
+}
+
+std::optional<WarmImage::EntryView> WarmImage::entry(size_t i) const {
+    const uint8_t* base = mapping.data();
+    size_t data_offset = IMAGE_HEADER_SIZE + count * IMAGE_ENTRY_SIZE;
+    size_t data_size = mapping.size() - data_offset;
+    const uint8_t* fields = base + IMAGE_HEADER_SIZE + i * IMAGE_ENTRY_SIZE;
+
+    // Every access is bounds-checked, so a damaged image cannot be read past its end
+    size_t key_offset = getLittleEndian<uint32_t>(fields);
+    size_t key_size = getLittleEndian<uint32_t>(fields + 4);
+    size_t value_offset = getLittleEndian<uint32_t>(fields + 8);
+    size_t value_size = getLittleEndian<uint32_t>(fields + 12);
+    if (key_offset > data_size || key_size > data_size - key_offset || value_offset > data_size ||
+        value_size > data_size - value_offset) {
+        return std::nullopt;
+    }
+    const char* key = reinterpret_cast<const char*>(base + data_offset + key_offset);
+    return EntryView{std::string_view(key, key_size), base + data_offset + value_offset, value_size};
+}
+
+} // namespace kvs_demo
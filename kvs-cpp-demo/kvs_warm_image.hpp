@@ -0,0 +1,86 @@
+/********************************************************************************
+ * Copyright (c) 2025 Contributors to the Eclipse Foundation
+ *
+ * See the NOTICE file(s) distributed with this work for additional
+ * information regarding copyright ownership.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Apache License Version 2.0 which is available at
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ ********************************************************************************/
+
+/**
+ * @file kvs_warm_image.hpp
+ * @brief Memory-mappable checkpoint of a store for fast startup
+ *
+ * KvsBuilder::build() reads, hashes and parses the whole JSON file before
+ * the first value can be read. A warm image, written next to the store
+ * after a flush as kvs_<id>_0.img, holds the same contents in a layout that
+ * is used in place from a read-only mapping; all references are offsets,
+ * so nothing needs fixing up:
+ *
+ *   offset  size  field (little-endian)
+ *   0       4     magic "KVWI"
+ *   4       4     format version (2)
+ *   8       8     FNV-1a 64 of the JSON the image was made from
+ *   16      8     size of that JSON in bytes
+ *   24      8     entry count n
+ *   32      16*n  entries sorted by key: u32 key offset, u32 key length,
+ *                 u32 value offset, u32 value length (offsets into the data)
+ *   32+16n        data: key bytes and values in kvs_value_codec.hpp encoding
+ *
+ * open() maps the file and checks it against the current JSON: a size
+ * mismatch is refused straight away, otherwise the JSON is mapped and
+ * hashed. The store's own Adler-32 is not used for this, since two
+ * generations of the same size collide on it far too easily. Hashing runs
+ * at memory speed, well below the cost of parsing. get_value() is a binary
+ * search plus decoding of that one value. A stale or damaged image is
+ * refused, and the caller falls back to the JSON store.
+ */
+
+#ifndef KVS_DEMO_WARM_IMAGE_HPP
+#define KVS_DEMO_WARM_IMAGE_HPP
+
+#include "kvs_blob_store.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kvs_demo {
+
+class WarmImage {
+public:
+    /// Write the image for the instance's current store generation; call
+    /// after a successful flush.
+    static bool write(Kvs& kvs, const std::string& dir, InstanceId instance_id);
+
+    /// Map the image, or nothing if it is missing, stale or malformed.
+    static std::optional<WarmImage> open(const std::string& dir, InstanceId instance_id);
+
+    size_t size() const { return count; }
+    std::optional<KvsValue> get_value(std::string_view key) const;
+    std::vector<std::string> get_all_keys() const;
+
+private:
+    struct EntryView {
+        std::string_view key;
+        const uint8_t* value;
+        size_t value_size;
+    };
+
+    WarmImage(MappedBlob mapping, size_t count) : mapping(std::move(mapping)), count(count) {}
+
+    std::optional<EntryView> entry(size_t i) const;
+
+    MappedBlob mapping;
+    size_t count;
+};
+
+} // namespace kvs_demo
+
+#endif // KVS_DEMO_WARM_IMAGE_HPP
@@ -6,6 +6,7 @@
  * - Working with different data types
  * - JSON-based persistence simulation
  * - File I/O operations
+ * - Raw byte values stored out of line, readable by the C++ demo
  *
  * Note: This is a simplified standalone demo. For full KVS functionality,
  * install and use the persistency Rust library (rust_kvs).
@@ -24,6 +25,39 @@ const YELLOW: &str = "\x1b[33m";
 const RED: &str = "\x1b[31m";
 const CYAN: &str = "\x1b[36m";
 
+// Byte values use the same layout as BlobStore in the C++ demo: the raw bytes
+// live in kvs_<id>_blobs/<fnv1a64>-<size>.blob and the store holds a reference
+// object { "$blob": name, "$size": size, "$type": BLOB_TYPE_BYTES }.
+const BLOB_TYPE_BYTES: i32 = 255;
+
+fn fnv1a64(data: &[u8]) -> u64 {
+    let mut hash: u64 = 0xcbf29ce484222325;
+    for byte in data {
+        hash ^= *byte as u64;
+        hash = hash.wrapping_mul(0x100000001b3);
+    }
+    hash
+}
+
+// Same deterministic pattern as makeCalibrationBlob() in the C++ demo
+fn calibration_pattern(len: usize) -> Vec<u8> {
+    (0..len).map(|i| ((i * 31 + 7) & 0xff) as u8).collect()
+}
+
+fn bytes_reference(value: &KvsValue) -> Option<(String, u64)> {
+    let KvsValue::Object(map) = value else {
+        return None;
+    };
+    match (map.get("$blob"), map.get("$size"), map.get("$type")) {
+        (Some(KvsValue::String(name)), Some(KvsValue::U64(size)), Some(KvsValue::I32(BLOB_TYPE_BYTES)))
+            if map.len() == 3 && !name.contains('/') && !name.contains("..") =>
+        {
+            Some((name.clone(), *size))
+        }
+        _ => None,
+    }
+}
+
 struct KvsDemo {
     data_dir: String,
 }
@@ -75,7 +109,10 @@ impl KvsDemo {
             KvsValue::String(v) => println!("{}\"{}\" (string){}", GREEN, v, RESET),
             KvsValue::Null => println!("{}null{} (null)", GREEN, RESET),
             KvsValue::Array(v) => println!("{}[array with {} elements]{} (array)", GREEN, v.len(), RESET),
-            KvsValue::Object(v) => println!("{}{{object with {} properties}}{} (object)", GREEN, v.len(), RESET),
+            KvsValue::Object(v) => match bytes_reference(value) {
+                Some((_, size)) => println!("{}<{} bytes>{} (bytes)", GREEN, size, RESET),
+                None => println!("{}{{object with {} properties}}{} (object)", GREEN, v.len(), RESET),
+            },
         }
     }
 
@@ -181,6 +218,104 @@ impl KvsDemo {
         Ok(())
     }
 
+    fn blob_dir(&self, instance_id: &InstanceId) -> PathBuf {
+        PathBuf::from(&self.data_dir).join(format!("kvs_{}_blobs", instance_id.0))
+    }
+
+    /// Write bytes to their content-addressed blob file (once) and return
+    /// the reference object to store in the KVS.
+    fn write_bytes(&self, instance_id: &InstanceId, bytes: &[u8]) -> Result<KvsMap, ErrorCode> {
+        let dir = self.blob_dir(instance_id);
+        std::fs::create_dir_all(&dir)?;
+
+        // Same naming as BlobStore: a name held by other bytes gets a -<n> suffix
+        let hash = fnv1a64(bytes);
+        let mut name = None;
+        for attempt in 0..16 {
+            let candidate = if attempt == 0 {
+                format!("{:016x}-{}.blob", hash, bytes.len())
+            } else {
+                format!("{:016x}-{}-{}.blob", hash, bytes.len(), attempt)
+            };
+            let path = dir.join(&candidate);
+            match std::fs::read(&path) {
+                Ok(existing) if existing == bytes => {}
+                Ok(_) => continue,
+                Err(_) => {
+                    let tmp_path = dir.join(format!("{}.tmp", candidate));
+                    let mut file = std::fs::File::create(&tmp_path)?;
+                    file.write_all(bytes)?;
+                    file.sync_all()?;
+                    std::fs::rename(&tmp_path, &path)?;
+                }
+            }
+            name = Some(candidate);
+            break;
+        }
+        let Some(name) = name else {
+            return Err(std::io::Error::new(std::io::ErrorKind::AlreadyExists, "blob name collisions").into());
+        };
+
+        Ok(KvsMap::from([
+            ("$blob".to_string(), KvsValue::from(name)),
+            ("$size".to_string(), KvsValue::from(bytes.len() as u64)),
+            ("$type".to_string(), KvsValue::from(BLOB_TYPE_BYTES)),
+        ]))
+    }
+
+    /// Read the bytes behind a reference object.
+    fn read_bytes(&self, instance_id: &InstanceId, value: &KvsValue) -> Option<Vec<u8>> {
+        let (name, size) = bytes_reference(value)?;
+        let bytes = std::fs::read(self.blob_dir(instance_id).join(&name)).ok()?;
+        // The name starts with the FNV-1a hash of the contents
+        let intact = bytes.len() as u64 == size && name.starts_with(&format!("{:016x}-", fnv1a64(&bytes)));
+        intact.then_some(bytes)
+    }
+
+    fn demonstrate_bytes(&self) -> Result<(), ErrorCode> {
+        self.print_header("Raw Byte Values Demo");
+
+        let instance_id = InstanceId(8);
+        let builder = KvsBuilder::new(instance_id)
+            .dir(self.data_dir.clone())
+            .kvs_load(KvsLoad::Optional);
+        let kvs = builder.build()?;
+
+        self.print_sub_header("Storing a binary calibration blob");
+        let calibration = calibration_pattern(1700);
+        let reference = self.write_bytes(&instance_id, &calibration)?;
+        kvs.set_value("rust_calibration", reference)?;
+        self.print_success(&format!(
+            "Stored {} raw bytes (no base64, no array of integers)",
+            calibration.len()
+        ));
+
+        self.print_sub_header("Reading byte values");
+        for (key, len) in [("rust_calibration", 1700), ("cpp_calibration", 1500)] {
+            let Ok(value) = kvs.get_value(key) else {
+                self.print_info(&format!(
+                    "Key '{}' not present (run the other demo on the same directory)",
+                    key
+                ));
+                continue;
+            };
+            match self.read_bytes(&instance_id, &value) {
+                Some(bytes) if bytes == calibration_pattern(len) => {
+                    self.print_success(&format!("Verified '{}' ({} bytes)", key, bytes.len()))
+                }
+                _ => self.print_error(&format!("Content mismatch for '{}'", key)),
+            }
+        }
+
+        let value = kvs.get_value("rust_calibration")?;
+        self.print_kvs_value("rust_calibration", &value);
+
+        kvs.flush()?;
+        self.print_success("Byte references persisted");
+
+        Ok(())
+    }
+
     fn demonstrate_snapshots(&self) -> Result<(), ErrorCode> {
         self.print_header("Snapshot Management Demo");
 
@@ -382,6 +517,9 @@ impl KvsDemo {
         self.demonstrate_arrays_and_objects()?;
         self.wait_for_user();
 
+        self.demonstrate_bytes()?;
+        self.wait_for_user();
+
         self.demonstrate_snapshots()?;
         self.wait_for_user();
 
@@ -411,12 +549,13 @@ impl KvsDemo {
 }
 
 fn main() {
-    let args: Vec<String> = std::env::args().collect();
-    let data_dir = if args.len() > 1 {
-        args[1].clone()
-    } else {
-        "./rust_demo_data".to_string()
-    };
+    let args: Vec<String> = std::env::args().skip(1).collect();
+    let bytes_only = args.iter().any(|arg| arg == "--bytes");
+    let data_dir = args
+        .iter()
+        .find(|arg| !arg.starts_with("--"))
+        .cloned()
+        .unwrap_or_else(|| "./rust_demo_data".to_string());
 
     // Create data directory if it doesn't exist
     if let Err(e) = std::fs::create_dir_all(&data_dir) {
@@ -425,7 +564,12 @@ fn main() {
     }
 
     let demo = KvsDemo::new(data_dir);
-    if let Err(e) = demo.run() {
+    let result = if bytes_only {
+        demo.demonstrate_bytes()
+    } else {
+        demo.run()
+    };
+    if let Err(e) = result {
         eprintln!("{}Demo failed: {:?}{}", RED, e, RESET);
         std::process::exit(1);
     }